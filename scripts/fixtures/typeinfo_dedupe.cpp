@@ -0,0 +1,38 @@
+// Fixture for test_json_export.py: classes whose _ZTV symbol demangles to a
+// different name than their typeinfo string parses to (Foo<int*> vs. Foo,
+// Client[abi:cxx11] vs. Client). Each vtable must be reported exactly once.
+//
+//   g++ -std=c++17 -O0 -shared -fPIC typeinfo_dedupe.cpp -o libtypeinfo_dedupe.so
+//
+// Load the .so in IDA and run test_json_export.py.
+
+#include <string>
+
+namespace fixture {
+
+struct Base {
+    virtual ~Base() {}
+    virtual int id() const { return 0; }
+};
+
+template <typename T>
+struct Holder : Base {
+    T value{};
+    int id() const override { return 1; }
+};
+
+struct [[gnu::abi_tag("cxx11")]] Client : Base {
+    std::string name;
+    int id() const override { return 2; }
+};
+
+} // namespace fixture
+
+extern "C" int fixture_ids() {
+    fixture::Holder<int*> h;
+    fixture::Client c;
+    const fixture::Base* all[] = {&h, &c};
+    int sum = 0;
+    for (const fixture::Base* b : all) sum += b->id();
+    return sum;
+}
@@ -27,7 +27,8 @@ def test_scan():
             "address", "class_name", "display_name", "func_count",
             "pure_virtual_count", "is_abstract", "base_classes",
             "derived_classes", "derived_count", "has_multiple_inheritance",
-            "has_virtual_inheritance", "is_intermediate", "is_windows"
+            "has_virtual_inheritance", "is_intermediate", "is_windows",
+            "confidence", "secondary_vtables"
         }
         actual_keys = set(vtables[0].keys())
         missing = expected_keys - actual_keys
@@ -139,6 +140,94 @@ def test_hierarchy(vtables):
     print(f"  Funcs: {result['func_count']}, Abstract: {result['is_abstract']}")
 
 
+def test_unique_addresses(vtables):
+    print("\n=== Test: one entry per vtable address ===")
+    # Template and ABI-tagged classes are named differently by their _ZTV
+    # symbol and their typeinfo string; see fixtures/typeinfo_dedupe.cpp
+    seen = {}
+    for vt in vtables:
+        seen.setdefault(vt["address"], []).append(vt["class_name"])
+    dupes = {a: n for a, n in seen.items() if len(n) > 1}
+    if dupes:
+        print(f"FAIL: {len(dupes)} addresses reported more than once")
+        for addr, names in list(dupes.items())[:5]:
+            print(f"  {addr}: {names}")
+        return
+    tricky = [vt["class_name"] for vt in vtables
+              if "<" in vt["class_name"] or "[abi:" in vt["class_name"]]
+    print(f"OK: {len(seen)} distinct addresses, {len(tricky)} template/ABI-tagged classes")
+    for name in tricky[:5]:
+        print(f"  {name}")
+
+
+def test_stats():
+    print("\n=== Test: VTableExplorer_Stats() ===")
+    result = json.loads(idc.eval_idc("VTableExplorer_Stats()"))
+    expected_keys = {
+        "vtable_count", "class_count", "class_refs", "pool_bytes",
+        "vtable_bytes", "slot_cache_bytes", "rtti_cache_bytes", "rtti_records",
+        "group_bytes", "secondary_vtables", "construction_vtables", "resolved_thunks",
+        "string_equivalent_bytes"
+    }
+    missing = expected_keys - set(result.keys())
+    if missing:
+        print(f"FAIL: missing keys: {missing}")
+        return
+    print(f"OK: {result['vtable_count']} vtables, {result['class_count']} interned classes, "
+          f"{result['class_refs']} class references")
+    print(f"  Pool: {result['pool_bytes']} bytes, VTableInfo + ID arrays: {result['vtable_bytes']} bytes")
+    print(f"  Decoded slot cache: {result['slot_cache_bytes']} bytes")
+    print(f"  RTTI cache: {result['rtti_records']} records, {result['rtti_cache_bytes']} bytes")
+    print(f"  Vtable groups: {result['secondary_vtables']} secondary vtables, "
+          f"{result['construction_vtables']} construction vtables, "
+          f"{result['resolved_thunks']} thunks resolved, {result['group_bytes']} bytes")
+    print(f"  Same references as std::string copies: {result['string_equivalent_bytes']} bytes")
+
+
+def test_construction_vtables():
+    print("\n=== Test: VTableExplorer_ConstructionVtables() ===")
+    groups = json.loads(idc.eval_idc("VTableExplorer_ConstructionVtables()"))
+    if not groups:
+        print("SKIP: no _ZTC construction vtables (expected without virtual inheritance)")
+        return
+    for g in groups:
+        if not g["vtables"] or g["vtables"][0]["offset"] != 0:
+            print(f"FAIL: {g['name']} @ {g['address']}: no primary subobject vtable")
+            return
+    print(f"OK: {len(groups)} construction vtables")
+    for g in groups[:3]:
+        print(f"  {g['name']} @ {g['address']}: {len(g['vtables'])} subobject vtables")
+
+
+def test_name_check():
+    print("\n=== Test: VTableExplorer_NameCheck() ===")
+    result = json.loads(idc.eval_idc("VTableExplorer_NameCheck()"))
+    expected_keys = {
+        "checked", "fast_parsed", "compared", "mismatches", "examples",
+        "fast_ns", "demangle_ns", "golden_failures", "transform_names",
+        "normalize_ns", "clean_ns"
+    }
+    missing = expected_keys - set(result.keys())
+    if missing:
+        print(f"FAIL: missing keys: {missing}")
+        return
+    if result["golden_failures"]:
+        print(f"FAIL: {result['golden_failures']} MSVC name transform golden rows differ")
+        for e in result["examples"]:
+            print(f"  {e}")
+        return
+    if result["mismatches"]:
+        print(f"FAIL: {result['mismatches']} of {result['compared']} names differ from the demangler")
+        for e in result["examples"]:
+            print(f"  {e}")
+        return
+    print(f"OK: {result['fast_parsed']}/{result['checked']} names parsed without the demangler, "
+          f"{result['compared']} agree with it")
+    print(f"  {result['fast_ns']:.0f} ns/name fast, {result['demangle_ns']:.0f} ns/name demangle_name")
+    print(f"  MSVC transforms over {result['transform_names']} names: "
+          f"normalize {result['normalize_ns']:.1f} ns, clean {result['clean_ns']:.1f} ns")
+
+
 def test_error_handling():
     print("\n=== Test: Error handling ===")
     # Entries for nonexistent address
@@ -173,9 +262,13 @@ def main():
             test_entries(vtables)
             test_compare(vtables)
             test_hierarchy(vtables)
+            test_unique_addresses(vtables)
+            test_stats()
+            test_construction_vtables()
         else:
             print("\nNo vtables found in this binary (expected for non-C++ binaries)")
 
+        test_name_check()
         test_error_handling()
 
         print("\n" + "=" * 60)
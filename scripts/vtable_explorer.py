@@ -3,7 +3,7 @@
 Requires the VTableExplorer plugin (vtable64.dll) to be loaded.
 
 Usage:
-    from vtable_explorer import scan, entries, compare, hierarchy
+    from vtable_explorer import scan, entries, compare, hierarchy, stats, name_check
 
     # List all vtables
     for vt in scan():
@@ -23,6 +23,12 @@ Usage:
     h = hierarchy("CBaseEntity")
     print(f"Ancestors: {h['ancestors']}")
     print(f"Descendants: {h['descendants']}")
+
+    # Memory held by the cached scan
+    print(stats())
+
+    # Fast name parsers vs the demangler
+    print(name_check())
 """
 import idc
 import json
@@ -50,3 +56,13 @@ def hierarchy(class_name):
     return json.loads(
         idc.eval_idc(f'VTableExplorer_Hierarchy("{class_name}")')
     )
+
+
+def stats():
+    """Return the memory report for the cached scan."""
+    return json.loads(idc.eval_idc("VTableExplorer_Stats()"))
+
+
+def name_check():
+    """Compare the fast name parsers against the demangler and time both."""
+    return json.loads(idc.eval_idc("VTableExplorer_NameCheck()"))
@@ -0,0 +1,151 @@
+#pragma once
+#include <ida.hpp>
+#include <bytes.hpp>
+#include <funcs.hpp>
+#include <auto.hpp>
+#include <undo.hpp>
+#include <kernwin.hpp>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include "class_pool.h"
+#include "override_analysis.h"
+#include "smart_annotator.h"
+#include "vtable_detector.h"
+#include "vtable_utils.h"
+
+// Annotate All in two phases: every comment is synthesized up front on the
+// worker pool from the slot cache and the override table, then a single
+// main-thread pass writes only the comments that differ from the IDB.
+
+namespace annotation_plan {
+
+// Comments to write, in write order, with their text back to back
+struct plan_t {
+    std::vector<ea_t> eas;
+    std::vector<uint32> offsets;  // eas[i] -> text
+    std::vector<char> text;       // NUL-terminated
+    std::vector<ea_t> targets;    // slot targets, sorted and unique
+    int vtable_count = 0;
+    int func_count = 0;
+
+    void add(ea_t ea, const char* cmt) {
+        eas.push_back(ea);
+        offsets.push_back(uint32(text.size()));
+        text.insert(text.end(), cmt, cmt + strlen(cmt) + 1);
+    }
+
+    const char* comment(size_t i) const { return &text[offsets[i]]; }
+
+    void append(const plan_t& other) {
+        const uint32 base = uint32(text.size());
+        eas.insert(eas.end(), other.eas.begin(), other.eas.end());
+        for (uint32 off : other.offsets) offsets.push_back(base + off);
+        text.insert(text.end(), other.text.begin(), other.text.end());
+        targets.insert(targets.end(), other.targets.begin(), other.targets.end());
+        vtable_count += other.vtable_count;
+        func_count += other.func_count;
+    }
+};
+
+struct apply_result_t {
+    size_t written = 0;
+    size_t unchanged = 0;
+    size_t functions_created = 0;
+    bool cancelled = false;
+};
+
+// Slots of every listed vtable must already be in the cache: workers only
+// read the cache, the override table and the class pool.
+inline plan_t build(const std::vector<VTableInfo>& vtables,
+                    const override_analysis::override_table_t& overrides,
+                    const smart_annotator::slot_cache_t& slots,
+                    const std::vector<ea_t>& sorted_addrs)
+{
+    using namespace vtable_utils;
+
+    const int ptr_size = get_ptr_size();
+    std::vector<plan_t> parts(parallel_chunks(vtables.size()));
+
+    parallel_for(vtables.size(), [&](size_t chunk, size_t begin, size_t end) {
+        plan_t& out = parts[chunk];
+        char cmt_buf[COMMENT_BUFFER_SIZE];
+        char header_buf[256];
+
+        for (size_t n = begin; n < end; ++n) {
+            const VTableInfo& vt = vtables[n];
+            if (vt.is_intermediate) continue;
+
+            auto pos = std::lower_bound(sorted_addrs.begin(), sorted_addrs.end(), vt.address);
+            if (pos == sorted_addrs.end() || *pos != vt.address) continue;
+            const auto entries = slots.entries(size_t(pos - sorted_addrs.begin()), vt.address);
+
+            // Same base as the function browser
+            const class_pool::class_id_t base = !vt.base_ids.empty() ? vt.base_ids[0] : class_pool::NO_CLASS;
+            const override_analysis::edge_result_t* edge =
+                base != class_pool::NO_CLASS ? overrides.find(vt.class_id, base, vt.address) : nullptr;
+
+            // A slot comment on the vtable address itself replaces the header
+            if (entries.empty() || entries[0].entry_addr != vt.address) {
+                smart_annotator::format_vtable_comment(header_buf, sizeof(header_buf), vt.class_name(),
+                                                       base != class_pool::NO_CLASS ? class_pool::name_of(base) : nullptr);
+                out.add(vt.address, header_buf);
+            }
+
+            for (const auto& e : entries) {
+                int status = smart_annotator::NO_STATUS;
+                if (edge && uint32(e.index) < edge->slot_count)
+                    status = int(overrides.status(*edge, uint32(e.index)));
+                smart_annotator::format_slot_comment(cmt_buf, sizeof(cmt_buf), status, edge && edge->slot_count,
+                                                     e.is_pure_virtual, e.index, ptr_size);
+                out.add(e.entry_addr, cmt_buf);
+                out.targets.push_back(e.func_ptr);
+            }
+
+            out.func_count += int(entries.size());
+            out.vtable_count++;
+        }
+    });
+
+    plan_t plan = std::move(parts[0]);
+    for (size_t c = 1; c < parts.size(); ++c)
+        plan.append(parts[c]);
+
+    std::sort(plan.targets.begin(), plan.targets.end());
+    plan.targets.erase(std::unique(plan.targets.begin(), plan.targets.end()), plan.targets.end());
+    return plan;
+}
+
+// Writes the plan as one undo step with auto-analysis held off.
+// Comments that are already in place are left alone.
+inline apply_result_t apply(const plan_t& plan) {
+    apply_result_t r;
+
+    create_undo_point(nullptr, 0);
+    const bool auto_was_enabled = enable_auto(false);
+
+    for (ea_t target : plan.targets) {
+        if (!is_code(get_flags(target)) && add_func(target))
+            ++r.functions_created;
+    }
+
+    qstring existing;
+    for (size_t i = 0; i < plan.eas.size(); ++i) {
+        if ((i & 0x3FF) == 0 && user_cancelled()) {
+            r.cancelled = true;
+            break;
+        }
+        const char* cmt = plan.comment(i);
+        if (get_cmt(&existing, plan.eas[i], false) >= 0 && existing == cmt) {
+            ++r.unchanged;
+            continue;
+        }
+        set_cmt(plan.eas[i], cmt, false);
+        ++r.written;
+    }
+
+    enable_auto(auto_was_enabled);
+    return r;
+}
+
+} // namespace annotation_plan
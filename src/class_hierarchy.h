@@ -0,0 +1,98 @@
+#pragma once
+#include <ida.hpp>
+#include <vector>
+#include "class_pool.h"
+#include "vtable_detector.h"
+
+namespace class_hierarchy {
+
+using class_pool::class_id_t;
+
+// Compressed sparse row adjacency over class IDs: the neighbours of v are
+// cols[rows[v] .. rows[v + 1]). Immutable once built.
+struct csr_t {
+    std::vector<uint32> rows;
+    std::vector<class_id_t> cols;
+
+    const class_id_t* begin(class_id_t v) const {
+        return v + 1 < rows.size() ? cols.data() + rows[v] : nullptr;
+    }
+    const class_id_t* end(class_id_t v) const {
+        return v + 1 < rows.size() ? cols.data() + rows[v + 1] : nullptr;
+    }
+    size_t degree(class_id_t v) const { return end(v) - begin(v); }
+
+    size_t memory_usage() const {
+        return rows.capacity() * sizeof(uint32) + cols.capacity() * sizeof(class_id_t);
+    }
+};
+
+// Parent->child and child->parent edges of one refresh, taken from the
+// base_ids of every vtable. Children keep vtable order, parents keep RTTI order.
+struct hierarchy_t {
+    csr_t children;
+    csr_t parents;
+
+    void build(const std::vector<VTableInfo>& vtables, size_t class_count) {
+        children.rows.assign(class_count + 1, 0);
+        parents.rows.assign(class_count + 1, 0);
+
+        size_t edges = 0;
+        for (const auto& vt : vtables) {
+            for (class_id_t base : vt.base_ids) {
+                ++children.rows[base + 1];
+                ++parents.rows[vt.class_id + 1];
+                ++edges;
+            }
+        }
+        for (size_t v = 0; v < class_count; ++v) {
+            children.rows[v + 1] += children.rows[v];
+            parents.rows[v + 1] += parents.rows[v];
+        }
+
+        children.cols.assign(edges, class_pool::NO_CLASS);
+        parents.cols.assign(edges, class_pool::NO_CLASS);
+        std::vector<uint32> child_fill(children.rows.begin(), children.rows.end() - 1);
+        std::vector<uint32> parent_fill(parents.rows.begin(), parents.rows.end() - 1);
+        for (const auto& vt : vtables) {
+            for (class_id_t base : vt.base_ids) {
+                children.cols[child_fill[base]++] = vt.class_id;
+                parents.cols[parent_fill[vt.class_id]++] = base;
+            }
+        }
+    }
+
+    void clear() {
+        children = csr_t();
+        parents = csr_t();
+    }
+
+    // Depth-first, each class reported once; visit(id) returns false to stop descending
+    template<typename Visit>
+    void walk(const csr_t& adj, class_id_t root, std::vector<bool>& seen, Visit&& visit) const {
+        for (const class_id_t* it = adj.begin(root), *e = adj.end(root); it != e; ++it) {
+            const class_id_t next = *it;
+            if (next >= seen.size()) seen.resize(next + 1, false);
+            if (seen[next]) continue;
+            seen[next] = true;
+            if (visit(next))
+                walk(adj, next, seen, visit);
+        }
+    }
+
+    template<typename Visit>
+    void for_each_descendant(class_id_t root, Visit&& visit) const {
+        std::vector<bool> seen(children.rows.empty() ? 0 : children.rows.size() - 1, false);
+        walk(children, root, seen, [&](class_id_t id) { visit(id); return true; });
+    }
+
+    template<typename Visit>
+    void for_each_ancestor(class_id_t root, Visit&& visit) const {
+        std::vector<bool> seen(parents.rows.empty() ? 0 : parents.rows.size() - 1, false);
+        walk(parents, root, seen, [&](class_id_t id) { visit(id); return true; });
+    }
+
+    size_t memory_usage() const { return children.memory_usage() + parents.memory_usage(); }
+};
+
+} // namespace class_hierarchy
@@ -0,0 +1,114 @@
+#pragma once
+#include <ida.hpp>
+#include <string>
+#include <vector>
+#include <cstring>
+
+namespace class_pool {
+
+using class_id_t = uint32;
+constexpr class_id_t NO_CLASS = 0xFFFFFFFF;
+
+// Interned class names. Each distinct name is stored once in an arena and
+// addressed by a dense 32-bit ID, so hierarchy data can be kept as ID arrays
+// and ID-indexed vectors instead of string copies and string-keyed maps.
+// IDs stay valid until clear(); name() pointers until the next intern().
+struct class_pool_t {
+    std::vector<char> arena;         // NUL-terminated names, back to back
+    std::vector<uint32> offsets;     // id -> arena offset
+    std::vector<uint32> hashes;      // id -> name hash, reused when the table grows
+    std::vector<class_id_t> table;   // open addressing, power-of-two size
+
+    static uint32 hash(const char* s, size_t len) {
+        uint32 h = 2166136261u;
+        for (size_t i = 0; i < len; ++i) {
+            h ^= uint8(s[i]);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    size_t size() const { return offsets.size(); }
+
+    const char* name(class_id_t id) const {
+        return id < offsets.size() ? &arena[offsets[id]] : "";
+    }
+
+    size_t length(class_id_t id) const {
+        if (id >= offsets.size()) return 0;
+        size_t end = (id + 1 < offsets.size()) ? offsets[id + 1] : arena.size();
+        return end - offsets[id] - 1;
+    }
+
+    class_id_t find(const char* s, size_t len) const {
+        if (table.empty()) return NO_CLASS;
+        const uint32 h = hash(s, len);
+        const size_t mask = table.size() - 1;
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            class_id_t id = table[i];
+            if (id == NO_CLASS) return NO_CLASS;
+            if (hashes[id] == h && length(id) == len && memcmp(name(id), s, len) == 0)
+                return id;
+        }
+    }
+
+    class_id_t find(const std::string& s) const { return find(s.data(), s.size()); }
+
+    class_id_t intern(const char* s, size_t len) {
+        class_id_t id = find(s, len);
+        if (id != NO_CLASS) return id;
+
+        if ((offsets.size() + 1) * 2 > table.size())
+            grow();
+
+        id = class_id_t(offsets.size());
+        const uint32 h = hash(s, len);
+        offsets.push_back(uint32(arena.size()));
+        hashes.push_back(h);
+        arena.insert(arena.end(), s, s + len);
+        arena.push_back('\0');
+        insert_slot(id, h);
+        return id;
+    }
+
+    class_id_t intern(const std::string& s) { return intern(s.data(), s.size()); }
+
+    void clear() {
+        arena.clear();
+        offsets.clear();
+        hashes.clear();
+        table.clear();
+    }
+
+    size_t memory_usage() const {
+        return arena.capacity() + offsets.capacity() * sizeof(uint32) +
+               hashes.capacity() * sizeof(uint32) + table.capacity() * sizeof(class_id_t);
+    }
+
+private:
+    void insert_slot(class_id_t id, uint32 h) {
+        const size_t mask = table.size() - 1;
+        size_t i = h & mask;
+        while (table[i] != NO_CLASS) i = (i + 1) & mask;
+        table[i] = id;
+    }
+
+    void grow() {
+        table.assign(table.empty() ? 1024 : table.size() * 2, NO_CLASS);
+        for (class_id_t id = 0; id < offsets.size(); ++id)
+            insert_slot(id, hashes[id]);
+    }
+};
+
+static class_pool_t g_class_pool;
+
+inline const char* name_of(class_id_t id) { return g_class_pool.name(id); }
+inline class_id_t intern(const std::string& s) { return g_class_pool.intern(s); }
+inline class_id_t find(const std::string& s) { return g_class_pool.find(s); }
+
+// Orders IDs by name, matching the std::string ordering used for display
+inline bool name_less(class_id_t a, class_id_t b) {
+    return strcmp(name_of(a), name_of(b)) < 0;
+}
+
+} // namespace class_pool
@@ -6,6 +6,9 @@
 #include <map>
 #include <set>
 #include <string>
+#include "class_pool.h"
+#include "class_hierarchy.h"
+#include "override_analysis.h"
 #include "rtti_parser.h"
 #include "vtable_comparison.h"
 #include "vtable_utils.h"
@@ -40,41 +43,44 @@ struct graph_data_t {
     }
 };
 
+using class_pool::class_id_t;
+
+// Class ID -> its VTableInfo (nullptr if the class has no entry)
+using vtable_map_t = std::vector<const VTableInfo*>;
+
+inline const VTableInfo* lookup(const vtable_map_t& vtable_map, class_id_t cls) {
+    return cls < vtable_map.size() ? vtable_map[cls] : nullptr;
+}
+
 inline void collect_ancestors(
-    const std::string& cls,
-    const std::map<std::string, const VTableInfo*>& vtable_map,
-    std::set<std::string>& lineage)
+    class_id_t cls,
+    const vtable_map_t& vtable_map,
+    std::set<class_id_t>& lineage)
 {
-    auto it = vtable_map.find(cls);
-    if (it == vtable_map.end()) return;
-
-    const VTableInfo* vt = it->second;
+    const VTableInfo* vt = lookup(vtable_map, cls);
+    if (!vt) return;
 
-    if (vt->is_intermediate && !vt->parent_class.empty()) {
-        if (lineage.insert(vt->parent_class).second)
-            collect_ancestors(vt->parent_class, vtable_map, lineage);
+    if (vt->is_intermediate && vt->parent_id != class_pool::NO_CLASS) {
+        if (lineage.insert(vt->parent_id).second)
+            collect_ancestors(vt->parent_id, vtable_map, lineage);
         return;
     }
 
-    for (const auto& base : vt->base_classes) {
+    for (class_id_t base : vt->base_ids) {
         if (lineage.insert(base).second)
             collect_ancestors(base, vtable_map, lineage);
     }
 }
 
+// Only descends through classes not already in the lineage
 inline void collect_descendants(
-    const std::string& cls,
-    const std::vector<VTableInfo>* all_vtables,
-    std::set<std::string>& lineage)
+    class_id_t cls,
+    const class_hierarchy::hierarchy_t& hierarchy,
+    std::set<class_id_t>& lineage)
 {
-    for (const auto& vt : *all_vtables) {
-        for (const auto& base : vt.base_classes) {
-            if (base == cls && lineage.insert(vt.class_name).second) {
-                collect_descendants(vt.class_name, all_vtables, lineage);
-                break;
-            }
-        }
-    }
+    std::vector<bool> seen;
+    hierarchy.walk(hierarchy.children, cls, seen,
+                   [&](class_id_t id) { return lineage.insert(id).second; });
 }
 
 
@@ -111,19 +117,6 @@ static ssize_t idaapi graph_callback(void *ud, int code, va_list va) {
 }
 
 
-inline void calc_stats(ea_t child, ea_t parent, bool is_win,
-                       const std::vector<ea_t>& sorted,
-                       int& inherited, int& overridden, int& new_funcs)
-{
-    inherited = overridden = new_funcs = 0;
-    if (child == BADADDR || parent == BADADDR) return;
-
-    auto cmp = vtable_comparison::compare_vtables(child, parent, is_win, sorted);
-    inherited = cmp.inherited_count;
-    overridden = cmp.overridden_count;
-    new_funcs = cmp.new_virtual_count;
-}
-
 inline void pad_line(char* out, int sz, const char* lbl, const char* val, int w) {
     int pad = w - 4 - strlen(lbl) - strlen(val);
     if (pad < 1) pad = 1;
@@ -135,10 +128,12 @@ inline void pad_line(char* out, int sz, const char* lbl, const char* val, int w)
 }
 
 inline void show_inheritance_graph(
-    const std::string& class_name,
+    class_id_t class_id,
     ea_t vtable_addr,
     bool is_windows,
-    const std::vector<VTableInfo>* all_vtables)
+    const std::vector<VTableInfo>* all_vtables,
+    const class_hierarchy::hierarchy_t& hierarchy,
+    const override_analysis::override_table_t& overrides)
 {
     TWidget* existing = find_widget("Inheritance Lineage");
     if (existing) {
@@ -152,39 +147,39 @@ inline void show_inheritance_graph(
 
     show_wait_box("Building lineage...");
 
-    std::map<std::string, const VTableInfo*> vtable_map;
-    std::vector<ea_t> sorted_vtables;
-    sorted_vtables.reserve(all_vtables->size());
+    vtable_map_t vtable_map(class_pool::g_class_pool.size(), nullptr);
     for (const auto& vt : *all_vtables) {
-        vtable_map[vt.class_name] = &vt;
-        sorted_vtables.push_back(vt.address);
+        vtable_map[vt.class_id] = &vt;
     }
-    std::sort(sorted_vtables.begin(), sorted_vtables.end());
 
-    std::set<std::string> lineage;
-    lineage.insert(class_name);  // Add selected class
+    std::set<class_id_t> lineage;
+    lineage.insert(class_id);  // Add selected class
 
     size_t before_ancestors = lineage.size();
-    collect_ancestors(class_name, vtable_map, lineage);  // Add all parents up to root
+    collect_ancestors(class_id, vtable_map, lineage);  // Add all parents up to root
     size_t ancestors_count = lineage.size() - before_ancestors;
 
     size_t before_descendants = lineage.size();
-    collect_descendants(class_name, all_vtables, lineage);  // Add all children down
+    collect_descendants(class_id, hierarchy, lineage);  // Add all children down
     size_t descendants_count = lineage.size() - before_descendants;
 
+    // Nodes are laid out in class name order
+    std::vector<class_id_t> ordered(lineage.begin(), lineage.end());
+    std::sort(ordered.begin(), ordered.end(), class_pool::name_less);
+
     graph_data_t *data = new graph_data_t();
-    std::map<std::string, int> class_to_node;
+    std::map<class_id_t, int> class_to_node;
 
     using namespace vtable_utils;
     const uint32 NORMAL_COLOR = GRAPH_NORMAL;     // Medium-dark tan (good contrast)
     const uint32 SELECTED_COLOR = GRAPH_SELECTED; // Lighter tan for selection highlight
     const uint32 ABSTRACT_COLOR = GRAPH_ABSTRACT; // Medium purple (good contrast)
 
-    for (const std::string& cls : lineage) {
-        auto it = vtable_map.find(cls);
+    for (class_id_t cls : ordered) {
+        const VTableInfo* vt = lookup(vtable_map, cls);
+        const char* cls_name = class_pool::name_of(cls);
 
-        bool found = (it != vtable_map.end());
-        const VTableInfo* vt = found ? it->second : nullptr;
+        bool found = (vt != nullptr);
         bool is_intermediate = found ? vt->is_intermediate : true;
 
         char label[1024];
@@ -194,11 +189,11 @@ inline void show_inheritance_graph(
 
         // Intermediate node
         if (!found || is_intermediate) {
-            bool is_selected = (cls == class_name);
+            bool is_selected = (cls == class_id);
             if (is_selected) {
-                qsnprintf(lines[line_count++], 256, "  %s (SELECTED)  ", cls.c_str());
+                qsnprintf(lines[line_count++], 256, "  %s (SELECTED)  ", cls_name);
             } else {
-                qsnprintf(lines[line_count++], 256, "  %s  ", cls.c_str());
+                qsnprintf(lines[line_count++], 256, "  %s  ", cls_name);
             }
 
             int name_len = strlen(lines[0]);
@@ -223,7 +218,7 @@ inline void show_inheritance_graph(
 
             if (found && vt->parent_vtable_addr != BADADDR) {
                 char parent_ref[64];
-                qsnprintf(parent_ref, sizeof(parent_ref), "uses %s", vt->parent_class.c_str());
+                qsnprintf(parent_ref, sizeof(parent_ref), "uses %s", vt->parent_class());
                 pad_line(lines[line_count++], 256, "VTable  :", parent_ref, LINE_WIDTH);
             } else {
                 pad_line(lines[line_count++], 256, "VTable  :", "(none)", LINE_WIDTH);
@@ -243,15 +238,15 @@ inline void show_inheritance_graph(
             continue;
         }
 
-        bool is_selected = (cls == class_name);
+        bool is_selected = (cls == class_id);
         if (is_selected && is_abstract) {
-            qsnprintf(lines[line_count++], 256, "  %s [abstract] (SELECTED)  ", cls.c_str());
+            qsnprintf(lines[line_count++], 256, "  %s [abstract] (SELECTED)  ", cls_name);
         } else if (is_selected) {
-            qsnprintf(lines[line_count++], 256, "  %s (SELECTED)  ", cls.c_str());
+            qsnprintf(lines[line_count++], 256, "  %s (SELECTED)  ", cls_name);
         } else if (is_abstract) {
-            qsnprintf(lines[line_count++], 256, "  %s [abstract]  ", cls.c_str());
+            qsnprintf(lines[line_count++], 256, "  %s [abstract]  ", cls_name);
         } else {
-            qsnprintf(lines[line_count++], 256, "  %s  ", cls.c_str());
+            qsnprintf(lines[line_count++], 256, "  %s  ", cls_name);
         }
 
         int name_len = strlen(lines[0]);
@@ -288,20 +283,18 @@ inline void show_inheritance_graph(
         pad_line(lines[line_count++], 256, "Funcs   :", funcs_val, LINE_WIDTH);
 
         char parent_val[128];
-        ea_t parent_vtable_addr = BADADDR;
-        std::string stats_parent_name;
-        if (!vt->base_classes.empty()) {
-            const char* parent_name = vt->base_classes[0].c_str();
-            if (vt->base_classes.size() > 1) {
-                qsnprintf(parent_val, sizeof(parent_val), "%s (+%d)", parent_name, (int)vt->base_classes.size() - 1);
+        const override_analysis::edge_result_t* stats_edge = nullptr;
+        if (!vt->base_ids.empty()) {
+            const char* parent_name = class_pool::name_of(vt->base_ids[0]);
+            if (vt->base_ids.size() > 1) {
+                qsnprintf(parent_val, sizeof(parent_val), "%s (+%d)", parent_name, (int)vt->base_ids.size() - 1);
             } else {
                 qsnprintf(parent_val, sizeof(parent_val), "%s", parent_name);
             }
-            for (const auto& base : vt->base_classes) {
-                auto parent_it = vtable_map.find(base);
-                if (parent_it != vtable_map.end() && !parent_it->second->is_intermediate) {
-                    parent_vtable_addr = parent_it->second->address;
-                    stats_parent_name = base;
+            for (class_id_t base : vt->base_ids) {
+                const VTableInfo* parent_vt = lookup(vtable_map, base);
+                if (parent_vt && !parent_vt->is_intermediate) {
+                    stats_edge = overrides.find(cls, base);
                     break;
                 }
             }
@@ -314,14 +307,11 @@ inline void show_inheritance_graph(
         qsnprintf(kids_val, sizeof(kids_val), "%d", vt->derived_count);
         pad_line(lines[line_count++], 256, "Children:", kids_val, LINE_WIDTH);
 
-        if (parent_vtable_addr != BADADDR) {
-            int inherited = 0, overridden = 0, new_funcs = 0;
-            calc_stats(vt->address, parent_vtable_addr, vt->is_windows, sorted_vtables, inherited, overridden, new_funcs);
-
+        if (stats_edge) {
             char inh_val[16], ovr_val[16], new_val[16];
-            qsnprintf(inh_val, sizeof(inh_val), "%d", inherited);
-            qsnprintf(ovr_val, sizeof(ovr_val), "%d", overridden);
-            qsnprintf(new_val, sizeof(new_val), "%d", new_funcs);
+            qsnprintf(inh_val, sizeof(inh_val), "%d", stats_edge->inherited_count);
+            qsnprintf(ovr_val, sizeof(ovr_val), "%d", stats_edge->overridden_count);
+            qsnprintf(new_val, sizeof(new_val), "%d", stats_edge->new_virtual_count);
 
             pad_line(lines[line_count++], 256, "Inherit :", inh_val, LINE_WIDTH);
             pad_line(lines[line_count++], 256, "Override:", ovr_val, LINE_WIDTH);
@@ -334,23 +324,25 @@ inline void show_inheritance_graph(
             qstrncat(label, lines[i], sizeof(label) - strlen(label) - 1);
         }
 
-        uint32 color = (cls == class_name) ? SELECTED_COLOR : is_abstract ? ABSTRACT_COLOR : NORMAL_COLOR;
+        uint32 color = (cls == class_id) ? SELECTED_COLOR : is_abstract ? ABSTRACT_COLOR : NORMAL_COLOR;
 
         int node = data->add_node(label, vt->address, color);
         class_to_node[cls] = node;
     }
 
     // Edges
-    for (const std::string& cls : lineage) {
-        auto it = vtable_map.find(cls);
+    for (class_id_t cls : ordered) {
+        const VTableInfo* cls_vt = lookup(vtable_map, cls);
         int child_node = class_to_node[cls];
 
-        if (it == vtable_map.end()) {
-            for (const auto& [other_cls, other_vt] : vtable_map) {
-                for (size_t i = 0; i < other_vt->base_classes.size(); ++i) {
-                    if (other_vt->base_classes[i] == cls) {
-                        if (i + 1 < other_vt->base_classes.size()) {
-                            const std::string& parent = other_vt->base_classes[i + 1];
+        if (!cls_vt) {
+            // all_vtables is in class name order, like the old name-keyed map
+            for (const auto& other : *all_vtables) {
+                const VTableInfo* other_vt = &other;
+                for (size_t i = 0; i < other_vt->base_ids.size(); ++i) {
+                    if (other_vt->base_ids[i] == cls) {
+                        if (i + 1 < other_vt->base_ids.size()) {
+                            const class_id_t parent = other_vt->base_ids[i + 1];
                             auto parent_it = class_to_node.find(parent);
                             if (parent_it != class_to_node.end()) {
                                 data->add_edge(parent_it->second, child_node);
@@ -364,17 +356,17 @@ inline void show_inheritance_graph(
             continue;
         }
 
-        // Intermediate: use parent_class field
-        if (it->second->is_intermediate && !it->second->parent_class.empty()) {
-            auto parent_it = class_to_node.find(it->second->parent_class);
+        // Intermediate: use parent_id field
+        if (cls_vt->is_intermediate && cls_vt->parent_id != class_pool::NO_CLASS) {
+            auto parent_it = class_to_node.find(cls_vt->parent_id);
             if (parent_it != class_to_node.end()) {
                 data->add_edge(parent_it->second, child_node);
             }
             continue;
         }
 
-        if (!it->second->base_classes.empty()) {
-            const std::string& direct_parent = it->second->base_classes[0];
+        if (!cls_vt->base_ids.empty()) {
+            const class_id_t direct_parent = cls_vt->base_ids[0];
             auto parent_it = class_to_node.find(direct_parent);
             if (parent_it != class_to_node.end()) {
                 data->add_edge(parent_it->second, child_node);
@@ -410,7 +402,7 @@ inline void show_inheritance_graph(
     display_widget(viewer, WOPN_DP_TAB | WOPN_PERSIST);
     refresh_viewer(viewer);
 
-    int selected_node = class_to_node[class_name];
+    int selected_node = class_to_node[class_id];
     viewer_center_on(viewer, selected_node);
 
     graph_location_info_t gli;
@@ -156,6 +156,45 @@ struct ui_event_listener_t : public event_listener_t {
 
 static ui_event_listener_t ui_listener;
 
+struct idb_event_listener_t : public event_listener_t {
+    virtual ssize_t idaapi on_event(ssize_t code, va_list va) override {
+        switch (code) {
+            case idb_event::renamed: {
+                ea_t ea = va_arg(va, ea_t);
+                const char* new_name = va_arg(va, const char*);
+                va_arg(va, int);  // local_name
+                const char* old_name = va_arg(va, const char*);
+                g_vtable_cache.on_renamed(ea, new_name, old_name);
+                break;
+            }
+            case idb_event::byte_patched: {
+                ea_t ea = va_arg(va, ea_t);
+                g_vtable_cache.on_bytes_patched(ea);
+                break;
+            }
+            case idb_event::func_added: {
+                func_t* pfn = va_arg(va, func_t*);
+                if (pfn) g_vtable_cache.on_func_added(pfn->start_ea);
+                break;
+            }
+            // Segment bounds and permissions feed the exec ranges and the scan limits
+            case idb_event::segm_added:
+            case idb_event::segm_deleted:
+            case idb_event::segm_start_changed:
+            case idb_event::segm_end_changed:
+            case idb_event::segm_moved:
+            case idb_event::segm_attrs_updated:
+                g_vtable_cache.on_segments_changed();
+                break;
+            default:
+                break;
+        }
+        return 0;
+    }
+};
+
+static idb_event_listener_t idb_listener;
+
 struct vtable_plugin_ctx_t : public plugmod_t {
     virtual bool idaapi run(size_t) override {
         return true;
@@ -173,6 +212,17 @@ struct vtable_plugin_ctx_t : public plugmod_t {
         unregister_action("compbrowser:jump_base");
         unregister_action("compbrowser:toggle");
         unhook_event_listener(HT_UI, &ui_listener);
+        unhook_event_listener(HT_IDB, &idb_listener);
+        // Under PLUGIN_MULTI the next database reuses these globals
+        close_vtable_chooser();
+        g_vtable_cache.reset();
+        smart_annotator::g_symbol_index.clear();
+        smart_annotator::g_groups.clear();
+        smart_annotator::g_scan_limits.clear();
+        thunk_resolver::g_thunks.clear();
+        rtti_parser::clear_rtti_cache();
+        rtti_detector::reset_config();
+        class_pool::g_class_pool.clear();
     }
 };
 
@@ -269,6 +319,7 @@ plugmod_t* idaapi init() {
     register_action(desc_comptoggle);
 
     hook_event_listener(HT_UI, &ui_listener, nullptr, 0);
+    hook_event_listener(HT_IDB, &idb_listener, nullptr, 0);
 
     vtable_idc::register_vtable_idc_functions();
 
@@ -0,0 +1,202 @@
+#pragma once
+#include <ida.hpp>
+#include <segment.hpp>
+#include <bytes.hpp>
+#include <nalt.hpp>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+namespace memory_image {
+
+struct addr_range_t {
+    ea_t start_ea;
+    ea_t end_ea;
+};
+
+struct image_segment_t {
+    ea_t start_ea = BADADDR;
+    ea_t end_ea = BADADDR;
+    uint8 perm = 0;
+    bool loaded = false;        // false for bss/extern: mapped, but reads return zero
+    bool relro = false;         // ELF .data.rel.ro*: writable on disk, read-only once relocated
+    std::vector<uint8> bytes;   // end_ea - start_ea bytes when loaded
+};
+
+// Read-only copy of segment bytes and permissions. Lookups never touch the
+// kernel, so any thread may read while nobody calls capture()/clear().
+// capture() is the only member that calls into IDA; a synthetic segment
+// table can be built with add_segment() alone.
+struct memory_image_t {
+    std::vector<image_segment_t> segments;  // sorted by start_ea, non-overlapping
+    std::vector<addr_range_t> exec_ranges;  // executable segments, adjacent ones merged
+    ea_t imagebase = BADADDR;
+    bool valid = false;
+
+    const image_segment_t* find(ea_t ea) const {
+        auto it = std::upper_bound(segments.begin(), segments.end(), ea,
+            [](ea_t a, const image_segment_t& s) { return a < s.start_ea; });
+        if (it == segments.begin()) return nullptr;
+        --it;
+        return ea < it->end_ea ? &*it : nullptr;
+    }
+
+    bool is_mapped(ea_t ea) const { return find(ea) != nullptr; }
+
+    bool is_exec(ea_t ea) const {
+        const image_segment_t* s = find(ea);
+        return s && (s->perm & SEGPERM_EXEC);
+    }
+
+    // Contiguous bytes from ea to the end of its segment, nullptr if unmapped/unloaded
+    const uint8* view(ea_t ea, size_t* avail) const {
+        const image_segment_t* s = find(ea);
+        if (!s || !s->loaded) {
+            if (avail) *avail = 0;
+            return nullptr;
+        }
+        if (avail) *avail = size_t(s->end_ea - ea);
+        return s->bytes.data() + (ea - s->start_ea);
+    }
+
+    // Copies up to `size` bytes, crossing adjacent segments. Returns bytes produced.
+    size_t read(ea_t ea, void* out, size_t size) const {
+        uint8* dst = static_cast<uint8*>(out);
+        size_t done = 0;
+        while (done < size) {
+            const image_segment_t* s = find(ea + done);
+            if (!s) break;
+            size_t n = std::min<size_t>(size - done, size_t(s->end_ea - (ea + done)));
+            if (s->loaded) memcpy(dst + done, s->bytes.data() + (ea + done - s->start_ea), n);
+            else memset(dst + done, 0, n);
+            done += n;
+        }
+        return done;
+    }
+
+    template<typename T>
+    T read_scalar(ea_t ea) const {
+        T v = 0;
+        size_t avail = 0;
+        const uint8* p = view(ea, &avail);
+        if (p && avail >= sizeof(T)) memcpy(&v, p, sizeof(T));
+        else if (read(ea, &v, sizeof(T)) != sizeof(T)) v = 0;
+        return v;
+    }
+
+    uint8 get_byte(ea_t ea) const { return read_scalar<uint8>(ea); }
+    uint32 get_dword(ea_t ea) const { return read_scalar<uint32>(ea); }
+    uint64 get_qword(ea_t ea) const { return read_scalar<uint64>(ea); }
+
+    void add_segment(ea_t start, ea_t end, uint8 perm, std::vector<uint8> bytes, bool relro = false) {
+        image_segment_t s;
+        s.start_ea = start;
+        s.end_ea = end;
+        s.perm = perm;
+        s.relro = relro;
+        s.loaded = !bytes.empty();
+        s.bytes = std::move(bytes);
+        if (s.loaded) s.bytes.resize(size_t(end - start));
+        auto it = std::upper_bound(segments.begin(), segments.end(), start,
+            [](ea_t a, const image_segment_t& seg) { return a < seg.start_ea; });
+        segments.insert(it, std::move(s));
+        rebuild_exec_ranges();
+        valid = true;
+    }
+
+    void rebuild_exec_ranges() {
+        exec_ranges.clear();
+        for (const auto& s : segments) {
+            if (!(s.perm & SEGPERM_EXEC)) continue;
+            if (!exec_ranges.empty() && exec_ranges.back().end_ea == s.start_ea)
+                exec_ranges.back().end_ea = s.end_ea;
+            else
+                exec_ranges.push_back({s.start_ea, s.end_ea});
+        }
+    }
+
+    // Snapshot of the open database. Main thread only.
+    void capture() {
+        clear();
+        imagebase = get_imagebase();
+
+        for (int i = 0, n = get_segm_qty(); i < n; ++i) {
+            segment_t* seg = getnseg(i);
+            if (!seg || seg->end_ea <= seg->start_ea) continue;
+
+            std::vector<uint8> bytes;
+            if (seg->type != SEG_XTRN && seg->type != SEG_BSS) {
+                bytes.resize(size_t(seg->end_ea - seg->start_ea));
+                get_bytes(bytes.data(), (ssize_t)bytes.size(), seg->start_ea, GMB_READALL);
+            }
+            qstring name;
+            const bool relro = get_segm_name(&name, seg) > 0 && strncmp(name.c_str(), ".data.rel.ro", 12) == 0;
+            add_segment(seg->start_ea, seg->end_ea, seg->perm, std::move(bytes), relro);
+        }
+        valid = true;
+    }
+
+    void clear() {
+        segments.clear();
+        segments.shrink_to_fit();
+        exec_ranges.clear();
+        imagebase = BADADDR;
+        valid = false;
+    }
+
+    size_t memory_usage() const {
+        size_t total = segments.capacity() * sizeof(image_segment_t);
+        for (const auto& s : segments) total += s.bytes.capacity();
+        return total;
+    }
+};
+
+static memory_image_t g_image;
+
+// A segment's words (of some stride) within the concatenated word space of
+// all swept segments, so one parallel_for can cover every segment at once
+struct span_t {
+    const image_segment_t* seg;
+    ea_t first_word;   // aligned to the stride
+    size_t words;
+    size_t prefix;     // words in earlier spans
+};
+
+template<typename Pick>
+inline size_t collect_spans(int stride, Pick&& pick, std::vector<span_t>& out) {
+    out.clear();
+    size_t total = 0;
+    for (const auto& s : g_image.segments) {
+        if (!s.loaded || !pick(s)) continue;
+        const ea_t first = (s.start_ea + stride - 1) & ~ea_t(stride - 1);
+        if (first >= s.end_ea) continue;
+        const size_t words = size_t(s.end_ea - first) / stride;
+        if (!words) continue;
+        out.push_back({&s, first, words, total});
+        total += words;
+    }
+    return total;
+}
+
+// Calls fn(span, bytes at first_word, lo, hi) for each span's share of [begin, end)
+template<typename Fn>
+inline void for_each_piece(const std::vector<span_t>& spans, size_t begin, size_t end, Fn&& fn) {
+    for (const auto& sp : spans) {
+        const size_t lo = std::max(begin, sp.prefix);
+        const size_t hi = std::min(end, sp.prefix + sp.words);
+        if (lo >= hi) continue;
+        fn(sp, sp.seg->bytes.data() + (sp.first_word - sp.seg->start_ea), lo - sp.prefix, hi - sp.prefix);
+    }
+}
+
+// Keeps g_image populated for the lifetime of the scope (e.g. one cache refresh).
+// Nested scopes reuse the outer snapshot.
+struct image_scope_t {
+    bool owner;
+    image_scope_t() : owner(!g_image.valid) { if (owner) g_image.capture(); }
+    ~image_scope_t() { if (owner) g_image.clear(); }
+    image_scope_t(const image_scope_t&) = delete;
+    image_scope_t& operator=(const image_scope_t&) = delete;
+};
+
+} // namespace memory_image
@@ -0,0 +1,259 @@
+#pragma once
+#include <ida.hpp>
+#include <name.hpp>
+#include <demangle.hpp>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <cstring>
+#include "name_parser.h"
+#include "vtable_utils.h"
+
+// Differential check of name_parser against demangle_name(): a built-in
+// corpus plus every _ZTV/_ZTI/_ZTS/??_7 name in the database go through both,
+// and the class names are compared. Also times both paths, and checks and
+// times the MSVC name clean-up transforms in vtable_utils.
+
+namespace name_check {
+
+constexpr size_t MAX_EXAMPLES = 8;
+constexpr int BENCH_ROUNDS = 3;
+constexpr size_t TRANSFORM_BENCH_OPS = 1000000;
+
+// Forms the parsers cover plus a few they must hand back to the demangler
+static const char* const CORPUS[] = {
+    "_ZTV6Player",
+    "_ZTVN4game6PlayerE",
+    "_ZTVN4game2ui6WidgetE",
+    "_ZTVN4game6EntityINS_6PlayerEEE",
+    "_ZTVN4game6EntityIiEE",
+    "_ZTV3FooIiLi5EE",
+    "_ZTV3FooILin5ELb1EE",
+    "_ZTV3MapIjN4game6PlayerEE",
+    "_ZTVSt9exception",
+    "_ZTVSt13runtime_error",
+    "_ZTVNSt3__16vectorIiNS_9allocatorIiEEEE",
+    "_ZTVNSt7__cxx1115basic_stringbufIcSt11char_traitsIcESaIcEEE",
+    "_ZTISt6vectorIiSaIiEE",
+    "_ZTI3FooI3BarS0_E",
+    "_ZTIN1A1BIS_EE",
+    "_ZTIN1A1BIS0_EE",
+    "_ZTS6Player",
+    "_ZTSN4game6PlayerE",
+    "_ZTVN12_GLOBAL__N_13FooE",
+    "_ZTV3FooIPiE",
+    "_ZTS3FooIPiE",
+    "_ZTVN4game6ClientB5cxx11E",
+    "_ZTSN4game6ClientB5cxx11E",
+    "_ZTVN10__cxxabiv117__class_type_infoE",
+    "??_7Player@@6B@",
+    "??_7Player@game@@6B@",
+    "??_7Derived@ns@@6BBase@1@@",
+    "??_7type_info@@6B@",
+    "??_7exception@std@@6B@",
+    "??_7?$Foo@H@@6B@",
+    "??_7?$vector@HV?$allocator@H@std@@@std@@6B@",
+    ".?AVPlayer@game@@",
+    ".?AUPod@@",
+    ".?AVInner@Outer@0@",
+    ".?AV?$vector@H@std@@",
+    ".?AV<lambda_1>@@",
+};
+
+// Pinned behaviour of normalize_msvc_nested_class / clean_msvc_decorated_name,
+// quirks included
+struct golden_t {
+    const char* input;
+    const char* normalized;
+    const char* cleaned;
+};
+
+static const golden_t MSVC_GOLDEN[] = {
+    {"Player",            "Player",            "Player"},
+    {"Player@game",       "game::Player",      "Player@game"},
+    {"Inner@Outer@ns",    "ns::Outer::Inner",  "Inner@Outer@ns"},
+    {"Foo@@",             "Foo",               "Foo@@"},
+    {"@Foo",              "Foo",               "@Foo"},
+    {"a@@b",              "b::a",              "a@@b"},
+    {"@@",                "",                  "@@"},
+    {"",                  "",                  ""},
+    {"std::vector<int>",  "std::vector<int>",  "std::vector<int>"},
+    {"?$vector@H@std",    "std::H::?$vector",  "vector@H@std"},
+    {"Outer::?$Inner@H",  "H::Outer::?$Inner", "Inner@H"},
+    {"ns::$1A2B::Foo",    "ns::$1A2B::Foo",    "nsFoo"},
+    {"A::$x::B::$y::C",   "A::$x::B::$y::C",   "ABC"},
+    {"ns::$open",         "ns::$open",         "ns::$open"},
+    {"$1A2BFoo",          "$1A2BFoo",          "oo"},
+    {"$12",               "$12",               "$12"},
+    {"$ZZ",               "$ZZ",               "$ZZ"},
+    {"VPlayer",           "VPlayer",           "Player"},
+    {"UPod",              "UPod",              "Pod"},
+    {"Vector",            "Vector",            "Vector"},
+    {"V",                 "V",                 "V"},
+    {"$1FVFoo",           "$1FVFoo",           "Foo"},
+    {"::$a::",            "::$a::",            ""},
+};
+
+struct report_t {
+    size_t checked = 0;      // symbols run through both paths
+    size_t fast_parsed = 0;  // handled without the demangler
+    size_t compared = 0;     // both paths produced a class name
+    size_t mismatches = 0;
+    std::vector<std::string> examples;  // first few mismatches, "symbol: fast | demangler"
+    double fast_ns = 0;      // per symbol
+    double demangle_ns = 0;
+
+    size_t golden_failures = 0;     // MSVC_GOLDEN rows that no longer match
+    size_t transform_names = 0;     // distinct MSVC names behind the transform benchmark
+    double normalize_ns = 0;        // per call, over TRANSFORM_BENCH_OPS calls
+    double clean_ns = 0;
+};
+
+// Class name out of demangler text, whatever decoration this IDA uses
+// ("vtable for X", "`vtable for'X", "const X::`vftable'", "class X", ...)
+inline std::string class_from_text(const std::string& dem) {
+    const size_t vft = dem.find("::`vftable'");
+    if (vft != std::string::npos) {
+        const size_t c = dem.find("const ");
+        return c != std::string::npos && c < vft ? dem.substr(c + 6, vft - c - 6) : dem.substr(0, vft);
+    }
+    size_t f = dem.find(" for ");
+    if (f != std::string::npos) return dem.substr(f + 5);
+    f = dem.find(" for'");
+    if (f != std::string::npos) return dem.substr(f + 5);
+    if (dem.compare(0, 6, "class ") == 0) return dem.substr(6);
+    if (dem.compare(0, 7, "struct ") == 0) return dem.substr(7);
+    return dem;
+}
+
+// Drops spacing the two sides may disagree on: ", " and "> >", not "unsigned int"
+inline std::string canonical(const std::string& s) {
+    static const char* const punct = ",<>:*&";
+    std::string r;
+    r.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == ' ') {
+            const bool near_punct = (!r.empty() && strchr(punct, r.back())) ||
+                                    (i + 1 < s.size() && strchr(punct, s[i + 1]));
+            if (near_punct) continue;
+        }
+        r.push_back(s[i]);
+    }
+    return r;
+}
+
+inline bool is_checked_symbol(const char* name) {
+    return strncmp(name, "_ZTV", 4) == 0 || strncmp(name, "_ZTI", 4) == 0 ||
+           strncmp(name, "_ZTS", 4) == 0 || strncmp(name, "??_7", 4) == 0;
+}
+
+// Golden table, then TRANSFORM_BENCH_OPS calls of each transform cycling over
+// the scope part of the ??_7 symbols (the golden inputs when there are none)
+inline void check_msvc_transforms(const std::vector<std::string>& symbols, report_t& r) {
+    using clock = std::chrono::steady_clock;
+
+    std::vector<char> out(vtable_utils::NAME_STACK_BUFFER_SIZE);
+    auto fits = [&](size_t len) {
+        if (vtable_utils::normalized_capacity(len) > out.size()) out.resize(vtable_utils::normalized_capacity(len));
+    };
+
+    for (const auto& g : MSVC_GOLDEN) {
+        fits(strlen(g.input));
+        size_t n = vtable_utils::normalize_msvc_nested_class(g.input, out.data());
+        bool ok = std::string_view(out.data(), n) == g.normalized;
+        n = vtable_utils::clean_msvc_decorated_name(g.input, out.data());
+        ok &= std::string_view(out.data(), n) == g.cleaned;
+        if (!ok) {
+            ++r.golden_failures;
+            if (r.examples.size() < MAX_EXAMPLES) r.examples.push_back(std::string("golden: ") + g.input);
+        }
+    }
+
+    std::vector<std::string_view> names;
+    for (const auto& sym : symbols) {
+        if (sym.compare(0, 4, "??_7") != 0) continue;
+        const size_t marker = sym.find("@@6B", 4);
+        if (marker != std::string::npos) names.emplace_back(sym.data() + 4, marker - 4);
+    }
+    if (names.empty()) {
+        for (const auto& g : MSVC_GOLDEN) names.emplace_back(g.input);
+    }
+    for (const auto& n : names) fits(n.size());
+    r.transform_names = names.size();
+
+    volatile size_t sink = 0;
+    auto start = clock::now();
+    for (size_t i = 0, k = 0; i < TRANSFORM_BENCH_OPS; ++i, k = k + 1 == names.size() ? 0 : k + 1)
+        sink += vtable_utils::normalize_msvc_nested_class(names[k], out.data());
+    r.normalize_ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count()) /
+                     double(TRANSFORM_BENCH_OPS);
+
+    start = clock::now();
+    for (size_t i = 0, k = 0; i < TRANSFORM_BENCH_OPS; ++i, k = k + 1 == names.size() ? 0 : k + 1)
+        sink += vtable_utils::clean_msvc_decorated_name(names[k], out.data());
+    r.clean_ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count()) /
+                 double(TRANSFORM_BENCH_OPS);
+}
+
+// Main thread only: demangle_name() and the name list are kernel calls
+inline report_t run() {
+    using clock = std::chrono::steady_clock;
+
+    std::vector<std::string> symbols(std::begin(CORPUS), std::end(CORPUS));
+    const size_t count = get_nlist_size();
+    for (size_t i = 0; i < count; ++i) {
+        const char* name = get_nlist_name(i);
+        if (!name || !is_checked_symbol(name)) continue;
+        std::string sym(name);
+        if (sym.size() > 4 && sym.compare(sym.size() - 4, 4, "_ptr") == 0) sym.resize(sym.size() - 4);
+        symbols.push_back(std::move(sym));
+    }
+
+    report_t r;
+    r.checked = symbols.size();
+    check_msvc_transforms(symbols, r);
+
+    char buf[name_parser::NAME_BUFFER_SIZE];
+    volatile size_t sink = 0;  // keeps the timed loop from being optimized out
+
+    auto start = clock::now();
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+        for (const auto& sym : symbols)
+            sink += name_parser::class_of_symbol(sym, buf, sizeof(buf));
+    }
+    r.fast_ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count()) /
+                double(BENCH_ROUNDS * symbols.size());
+
+    std::vector<std::string> slow(symbols.size());
+    start = clock::now();
+    qstring dem;
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            const char* in = symbols[i].c_str();
+            if (*in == '.') ++in;
+            slow[i].clear();
+            if (demangle_name(&dem, in, MNG_NODEFINIT) > 0)
+                slow[i] = class_from_text(dem.c_str());
+        }
+    }
+    r.demangle_ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count()) /
+                    double(BENCH_ROUNDS * symbols.size());
+
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        const size_t n = name_parser::class_of_symbol(symbols[i], buf, sizeof(buf));
+        if (!n) continue;
+        ++r.fast_parsed;
+        if (slow[i].empty()) continue;
+        ++r.compared;
+
+        const std::string fast(buf, n);
+        if (canonical(fast) == canonical(slow[i])) continue;
+        ++r.mismatches;
+        if (r.examples.size() < MAX_EXAMPLES)
+            r.examples.push_back(symbols[i] + ": " + fast + " | " + slow[i]);
+    }
+    return r;
+}
+
+} // namespace name_check
@@ -0,0 +1,361 @@
+#pragma once
+#include <ida.hpp>
+#include <string_view>
+#include <cstring>
+
+// Allocation-free parsers for the mangled forms the detector sees most:
+// Itanium _ZTV/_ZTI/_ZTS <type> (nested names, template arguments,
+// substitutions) and MSVC ??_7...@@6B@ / .?AV...@@ / .?AU...@@. They write
+// the class name demangle_name() would produce into a caller buffer and
+// return its length, or 0 for any form they do not cover, in which case
+// the caller falls back to the demangler.
+
+namespace name_parser {
+
+constexpr size_t NAME_BUFFER_SIZE = 1024;
+constexpr size_t MAX_SUBSTITUTIONS = 64;
+constexpr size_t MAX_NAME_FRAGMENTS = 32;
+constexpr size_t MAX_MSVC_BACKREFS = 10;
+constexpr const char* TEMPLATE_ARG_SEPARATOR = ",";
+
+// Bounded writer into the caller's buffer; overflow fails the parse
+struct writer_t {
+    char* buf;
+    size_t cap;
+    size_t len = 0;
+    bool ok = true;
+
+    writer_t(char* b, size_t c) : buf(b), cap(c) {}
+
+    void put(const char* s, size_t n) {
+        if (!ok || len + n >= cap) { ok = false; return; }
+        memcpy(buf + len, s, n);
+        len += n;
+    }
+    void put(std::string_view s) { put(s.data(), s.size()); }
+    void put(char c) { put(&c, 1); }
+
+    // Appends an earlier part of the output (a substitution)
+    void repeat(size_t start, size_t n) {
+        if (!ok || len + n >= cap) { ok = false; return; }
+        memcpy(buf + len, buf + start, n);
+        len += n;
+    }
+
+    size_t finish() {
+        if (!ok || cap == 0) return 0;
+        buf[len] = '\0';
+        return len;
+    }
+};
+
+inline const char* itanium_builtin(char c) {
+    switch (c) {
+        case 'v': return "void";
+        case 'b': return "bool";
+        case 'c': return "char";
+        case 'a': return "signed char";
+        case 'h': return "unsigned char";
+        case 's': return "short";
+        case 't': return "unsigned short";
+        case 'i': return "int";
+        case 'j': return "unsigned int";
+        case 'l': return "long";
+        case 'm': return "unsigned long";
+        case 'f': return "float";
+        case 'd': return "double";
+        case 'w': return "wchar_t";
+        default:  return nullptr;
+    }
+}
+
+// Recursive-descent parser for the subset of <type> used by class names.
+// Substitution candidates are kept as spans of the output written so far.
+class itanium_parser_t {
+public:
+    itanium_parser_t(std::string_view s, writer_t& w) : s_(s), w_(w) {}
+
+    bool at_end() const { return pos_ == s_.size(); }
+
+    bool parse_type() {
+        const char c = peek();
+        if (const char* builtin = itanium_builtin(c)) {
+            ++pos_;
+            w_.put(builtin);
+            return w_.ok;
+        }
+        if (c == 'N') return parse_nested();
+
+        const size_t start = w_.len;
+        if (c >= '1' && c <= '9') {
+            if (!parse_source_name()) return false;
+            add_sub(start);
+            return parse_template_tail(start);
+        }
+        if (c == 'S') {
+            bool candidate = false;
+            if (!parse_substitution(true, candidate)) return false;
+            if (candidate) add_sub(start);
+            return parse_template_tail(start);
+        }
+        return false;  // pointers, cv-qualifiers, functions, template params...
+    }
+
+private:
+    std::string_view s_;
+    size_t pos_ = 0;
+    writer_t& w_;
+
+    struct span_t { size_t start, len; };
+    span_t subs_[MAX_SUBSTITUTIONS];
+    size_t sub_count_ = 0;
+    bool sub_overflow_ = false;
+
+    char peek(size_t k = 0) const { return pos_ + k < s_.size() ? s_[pos_ + k] : '\0'; }
+
+    void add_sub(size_t start) {
+        if (sub_count_ < MAX_SUBSTITUTIONS) subs_[sub_count_++] = {start, w_.len - start};
+        else sub_overflow_ = true;
+    }
+
+    // Optional template arguments after a name that started at `start`
+    bool parse_template_tail(size_t start) {
+        if (peek() != 'I') return w_.ok;
+        if (!parse_template_args()) return false;
+        add_sub(start);
+        return w_.ok;
+    }
+
+    bool parse_number(size_t& out) {
+        out = 0;
+        const size_t begin = pos_;
+        while (pos_ < s_.size() && s_[pos_] >= '0' && s_[pos_] <= '9') {
+            out = out * 10 + size_t(s_[pos_] - '0');
+            if (out > s_.size()) return false;
+            ++pos_;
+        }
+        return pos_ > begin;
+    }
+
+    bool parse_source_name() {
+        size_t len = 0;
+        if (!parse_number(len) || len == 0 || pos_ + len > s_.size()) return false;
+        const std::string_view id = s_.substr(pos_, len);
+        if (id.compare(0, 10, "_GLOBAL__N") == 0) return false;  // "(anonymous namespace)"
+        pos_ += len;
+        w_.put(id);
+        return w_.ok;
+    }
+
+    // S_, S<seq>_, St<name>, Sa, Sb. `candidate` reports whether the text
+    // written is a new substitution candidate (only St<name> is).
+    bool parse_substitution(bool allow_std_name, bool& candidate) {
+        candidate = false;
+        if (peek() != 'S') return false;
+        const char c = peek(1);
+
+        if (c == 't') {
+            if (!allow_std_name) return false;
+            pos_ += 2;
+            w_.put("std::");
+            if (!(peek() >= '1' && peek() <= '9') || !parse_source_name()) return false;
+            candidate = true;
+            return true;
+        }
+        if (c == 'a') { pos_ += 2; w_.put("std::allocator"); return w_.ok; }
+        if (c == 'b') { pos_ += 2; w_.put("std::basic_string"); return w_.ok; }
+
+        size_t index = 0;
+        if (c == '_') {
+            pos_ += 2;
+        } else {
+            // Base-36 sequence id, plus one
+            pos_ += 1;
+            size_t seq = 0;
+            bool any = false;
+            while (peek() != '_') {
+                const char d = peek();
+                int v;
+                if (d >= '0' && d <= '9') v = d - '0';
+                else if (d >= 'A' && d <= 'Z') v = d - 'A' + 10;
+                else return false;  // Ss, Si, So, Sd and friends
+                seq = seq * 36 + size_t(v);
+                if (seq >= MAX_SUBSTITUTIONS) return false;
+                any = true;
+                ++pos_;
+            }
+            if (!any) return false;
+            ++pos_;
+            index = seq + 1;
+        }
+        if (sub_overflow_ || index >= sub_count_) return false;
+        w_.repeat(subs_[index].start, subs_[index].len);
+        return w_.ok;
+    }
+
+    bool parse_nested() {
+        ++pos_;  // N
+        const char q = peek();
+        if (q == 'r' || q == 'V' || q == 'K' || q == 'R' || q == 'O') return false;  // member function qualifiers
+
+        const size_t start = w_.len;
+        bool first = true;
+        while (peek() != 'E') {
+            const char c = peek();
+            if (c >= '1' && c <= '9') {
+                if (!first) w_.put("::");
+                if (!parse_source_name()) return false;
+                add_sub(start);
+            } else if (c == 'S' && first) {
+                if (peek(1) == 't') {
+                    pos_ += 2;
+                    w_.put("std");
+                } else {
+                    bool candidate = false;
+                    if (!parse_substitution(false, candidate)) return false;
+                }
+            } else if (c == 'I' && !first) {
+                if (!parse_template_args()) return false;
+                add_sub(start);
+            } else {
+                return false;  // ctor/dtor names, operators, local names...
+            }
+            first = false;
+        }
+        ++pos_;  // E
+        return !first && w_.ok;
+    }
+
+    bool parse_literal() {
+        ++pos_;  // L
+        const char type = peek();
+        if (!type) return false;
+        ++pos_;
+        if (type == 'b') {
+            const char v = peek();
+            if ((v != '0' && v != '1') || peek(1) != 'E') return false;
+            w_.put(v == '1' ? "true" : "false");
+            pos_ += 2;
+            return w_.ok;
+        }
+        if (type != 'i') return false;
+        if (peek() == 'n') {
+            w_.put('-');
+            ++pos_;
+        }
+        const size_t begin = pos_;
+        while (peek() >= '0' && peek() <= '9') ++pos_;
+        if (pos_ == begin || peek() != 'E') return false;
+        w_.put(s_.substr(begin, pos_ - begin));
+        ++pos_;
+        return w_.ok;
+    }
+
+    bool parse_template_args() {
+        ++pos_;  // I
+        w_.put('<');
+        bool first = true;
+        while (peek() != 'E') {
+            if (pos_ >= s_.size()) return false;
+            if (!first) w_.put(TEMPLATE_ARG_SEPARATOR);
+            if (!(peek() == 'L' ? parse_literal() : parse_type())) return false;
+            first = false;
+        }
+        ++pos_;  // E
+        if (first) return false;
+        w_.put('>');
+        return w_.ok;
+    }
+};
+
+// Class name of an Itanium special-name symbol: prefix "_ZTV", "_ZTI" or "_ZTS"
+// followed by a <type> and nothing else
+inline size_t itanium_class(std::string_view sym, std::string_view prefix, char* out, size_t cap) {
+    if (sym.size() <= prefix.size() || sym.compare(0, prefix.size(), prefix) != 0) return 0;
+    writer_t w(out, cap);
+    itanium_parser_t p(sym.substr(prefix.size()), w);
+    if (!p.parse_type() || !p.at_end()) return 0;
+    return w.finish();
+}
+
+inline bool is_msvc_identifier(std::string_view s) {
+    if (s.empty()) return false;
+    for (char c : s) {
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_'))
+            return false;
+    }
+    return true;
+}
+
+// MSVC qualified name from `pos` up to and including its closing '@',
+// written outermost scope first. Returns the position after the name, 0 for
+// templates, anonymous namespaces and other special fragments.
+inline size_t msvc_qualified_name(std::string_view s, size_t pos, writer_t& w) {
+    std::string_view frags[MAX_NAME_FRAGMENTS];
+    std::string_view backrefs[MAX_MSVC_BACKREFS];
+    size_t frag_count = 0;
+    size_t backref_count = 0;
+
+    for (;;) {
+        if (pos >= s.size()) return 0;
+        const char c = s[pos];
+        if (c == '@') { ++pos; break; }
+
+        std::string_view frag;
+        if (c >= '0' && c <= '9') {
+            const size_t idx = size_t(c - '0');
+            if (idx >= backref_count) return 0;
+            frag = backrefs[idx];
+            ++pos;
+        } else {
+            const size_t at = s.find('@', pos);
+            if (at == std::string_view::npos) return 0;
+            frag = s.substr(pos, at - pos);
+            if (!is_msvc_identifier(frag)) return 0;  // ?$templates, ?A anonymous namespaces, $ names
+            pos = at + 1;
+
+            bool known = false;
+            for (size_t i = 0; i < backref_count; ++i) known |= backrefs[i] == frag;
+            if (!known && backref_count < MAX_MSVC_BACKREFS) backrefs[backref_count++] = frag;
+        }
+        if (frag_count == MAX_NAME_FRAGMENTS) return 0;
+        frags[frag_count++] = frag;
+    }
+    if (frag_count == 0) return 0;
+
+    for (size_t i = frag_count; i-- > 0;) {
+        w.put(frags[i]);
+        if (i) w.put("::");
+    }
+    return w.ok ? pos : 0;
+}
+
+// Class of a ??_7<name>@@6B... vftable symbol ("const <class>::`vftable'")
+inline size_t msvc_vtable_class(std::string_view sym, char* out, size_t cap) {
+    if (sym.compare(0, 4, "??_7") != 0) return 0;
+    writer_t w(out, cap);
+    const size_t end = msvc_qualified_name(sym, 4, w);
+    if (!end || sym.compare(end, 2, "6B") != 0) return 0;
+    return w.finish();
+}
+
+// Class of a TypeDescriptor name, with or without the leading '.':
+// .?AV<name>@@ ("class <name>") or .?AU<name>@@ ("struct <name>")
+inline size_t msvc_type_class(std::string_view raw, char* out, size_t cap) {
+    if (!raw.empty() && raw[0] == '.') raw.remove_prefix(1);
+    if (raw.compare(0, 3, "?AV") != 0 && raw.compare(0, 3, "?AU") != 0) return 0;
+    writer_t w(out, cap);
+    const size_t end = msvc_qualified_name(raw, 3, w);
+    if (!end || end != raw.size()) return 0;
+    return w.finish();
+}
+
+// Any of the above, picked by prefix
+inline size_t class_of_symbol(std::string_view sym, char* out, size_t cap) {
+    if (sym.compare(0, 4, "_ZTV") == 0 || sym.compare(0, 4, "_ZTI") == 0 || sym.compare(0, 4, "_ZTS") == 0)
+        return itanium_class(sym, sym.substr(0, 4), out, cap);
+    if (sym.compare(0, 4, "??_7") == 0) return msvc_vtable_class(sym, out, cap);
+    return msvc_type_class(sym, out, cap);
+}
+
+} // namespace name_parser
@@ -0,0 +1,198 @@
+#pragma once
+#include <ida.hpp>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include "class_pool.h"
+#include "class_hierarchy.h"
+#include "smart_annotator.h"
+#include "thunk_resolver.h"
+#include "vtable_comparison.h"
+#include "vtable_detector.h"
+
+// Override status of every slot of every vtable against each of its bases
+// that has a vtable, computed in one top-down pass over the class hierarchy.
+// Each vtable's slots are decoded once per pass instead of once per pair.
+// A derived class is compared through its vtable for that base's subobject,
+// and slots match when they reach the same function through adjustor thunks.
+
+namespace override_analysis {
+
+using class_pool::class_id_t;
+using vtable_comparison::OverrideStatus;
+
+constexpr uint32 NO_EDGE = UINT32_MAX;
+constexpr int STATUS_BITS = 3;
+constexpr int SLOTS_PER_WORD = 64 / STATUS_BITS;  // no slot straddles two words
+
+// One analysed derived -> base pair
+struct edge_result_t {
+    ea_t derived_vtable;  // the derived class's vtable facing base (primary or secondary)
+    ea_t base_vtable;
+    uint32 first_slot;    // into override_table_t::bits
+    uint32 slot_count;    // derived vtable's entries, by vfunc index
+    int inherited_count;
+    int overridden_count;
+    int new_virtual_count;
+};
+
+struct override_table_t {
+    std::vector<uint32> edge_of;        // parents CSR edge -> results index, NO_EDGE if not analysed
+    std::vector<edge_result_t> results;
+    std::vector<uint64> bits;           // STATUS_BITS per slot, SLOTS_PER_WORD per word
+    const class_hierarchy::hierarchy_t* hierarchy = nullptr;
+    bool valid = false;
+
+    OverrideStatus status(const edge_result_t& e, uint32 index) const {
+        const uint32 slot = e.first_slot + index;
+        const uint64 word = bits[slot / SLOTS_PER_WORD];
+        return OverrideStatus((word >> ((slot % SLOTS_PER_WORD) * STATUS_BITS)) & 7);
+    }
+
+    // Result for derived against base, nullptr if either has no vtable
+    const edge_result_t* find(class_id_t derived, class_id_t base) const {
+        if (!valid || !hierarchy) return nullptr;
+        const auto& parents = hierarchy->parents;
+        const class_id_t* first = parents.begin(derived);
+        for (const class_id_t* it = first; it != parents.end(derived); ++it) {
+            if (*it != base) continue;
+            const uint32 r = edge_of[it - parents.cols.data()];
+            return r == NO_EDGE ? nullptr : &results[r];
+        }
+        return nullptr;
+    }
+
+    // find(), for statuses laid over the slots of derived_vtable
+    const edge_result_t* find(class_id_t derived, class_id_t base, ea_t derived_vtable) const {
+        const edge_result_t* e = find(derived, base);
+        return e && e->derived_vtable == derived_vtable ? e : nullptr;
+    }
+
+    // Index -> status, as annotate_vtable() (int) and the function browser take it
+    template<typename Value>
+    void fill_status_map(const edge_result_t& e, std::map<int, Value>& out) const {
+        for (uint32 i = 0; i < e.slot_count; ++i)
+            out[int(i)] = static_cast<Value>(status(e, i));
+    }
+
+    void clear() {
+        edge_of.clear();
+        results.clear();
+        bits.clear();
+        hierarchy = nullptr;
+        valid = false;
+    }
+
+    size_t memory_usage() const {
+        return edge_of.capacity() * sizeof(uint32) + results.capacity() * sizeof(edge_result_t) +
+               bits.capacity() * sizeof(uint64);
+    }
+
+    // position_of(class) -> index into vtables or SIZE_MAX;
+    // vtable_for(position, base class) -> that class's vtable facing base;
+    // load_entries(vtable, is_windows) -> that vtable's entries
+    template<typename PositionOf, typename VTableFor, typename LoadEntries>
+    void build(const std::vector<VTableInfo>& vtables,
+               const class_hierarchy::hierarchy_t& graph,
+               PositionOf&& position_of,
+               VTableFor&& vtable_for,
+               LoadEntries&& load_entries)
+    {
+        clear();
+        hierarchy = &graph;
+        edge_of.assign(graph.parents.cols.size(), NO_EDGE);
+
+        const size_t class_count = graph.parents.rows.empty() ? 0 : graph.parents.rows.size() - 1;
+
+        // Decoded once per pass, by vtable address
+        std::unordered_map<ea_t, std::vector<smart_annotator::VTableEntry>> entries;
+        entries.reserve(vtables.size());
+        auto entries_of = [&](ea_t vt, bool is_windows) -> const std::vector<smart_annotator::VTableEntry>& {
+            auto it = entries.find(vt);
+            if (it == entries.end()) it = entries.emplace(vt, load_entries(vt, is_windows)).first;
+            return it->second;
+        };
+        auto& thunks = thunk_resolver::g_thunks;
+
+        auto analyse = [&](class_id_t derived) {
+            const size_t dpos = position_of(derived);
+            if (dpos >= vtables.size() || vtables[dpos].is_intermediate) return;
+
+            for (const class_id_t* it = graph.parents.begin(derived); it != graph.parents.end(derived); ++it) {
+                const size_t bpos = position_of(*it);
+                if (bpos >= vtables.size() || vtables[bpos].is_intermediate) continue;
+
+                const ea_t dvt = vtable_for(dpos, *it);
+                const auto& d = entries_of(dvt, vtables[dpos].is_windows);
+                const auto& b = entries_of(vtables[bpos].address, vtables[bpos].is_windows);
+
+                edge_result_t e;
+                e.derived_vtable = dvt;
+                e.base_vtable = vtables[bpos].address;
+                e.first_slot = uint32(total_slots());
+                e.slot_count = uint32(d.size());
+                e.inherited_count = e.overridden_count = e.new_virtual_count = 0;
+                bits.resize((e.first_slot + e.slot_count + SLOTS_PER_WORD - 1) / SLOTS_PER_WORD, 0);
+
+                // Entries are numbered 0..n-1, so index doubles as position
+                for (uint32 i = 0; i < e.slot_count; ++i) {
+                    OverrideStatus s;
+                    if (i < b.size()) {
+                        if (thunks.same_function(d[i].func_ptr, b[i].func_ptr)) {
+                            s = OverrideStatus::INHERITED;
+                            ++e.inherited_count;
+                        } else {
+                            if (b[i].is_pure_virtual && !d[i].is_pure_virtual)
+                                s = OverrideStatus::PURE_TO_IMPL;
+                            else if (!b[i].is_pure_virtual && d[i].is_pure_virtual)
+                                s = OverrideStatus::IMPL_TO_PURE;
+                            else
+                                s = OverrideStatus::OVERRIDDEN;
+                            ++e.overridden_count;
+                        }
+                    } else {
+                        s = OverrideStatus::NEW_VIRTUAL;
+                        ++e.new_virtual_count;
+                    }
+                    const uint32 slot = e.first_slot + i;
+                    bits[slot / SLOTS_PER_WORD] |= uint64(s) << ((slot % SLOTS_PER_WORD) * STATUS_BITS);
+                }
+
+                edge_of[it - graph.parents.cols.data()] = uint32(results.size());
+                results.push_back(e);
+            }
+        };
+
+        // Top-down: a class is analysed once all of its bases have been
+        std::vector<uint32> pending(class_count, 0);
+        for (class_id_t c = 0; c < class_count; ++c)
+            pending[c] = uint32(graph.parents.degree(c));
+
+        std::vector<class_id_t> queue;
+        queue.reserve(class_count);
+        for (class_id_t c = 0; c < class_count; ++c)
+            if (pending[c] == 0) queue.push_back(c);
+
+        std::vector<bool> done(class_count, false);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const class_id_t c = queue[head];
+            done[c] = true;
+            analyse(c);
+            for (const class_id_t* it = graph.children.begin(c); it != graph.children.end(c); ++it)
+                if (--pending[*it] == 0) queue.push_back(*it);
+        }
+
+        // Classes on an inheritance cycle (malformed RTTI) never become ready
+        for (class_id_t c = 0; c < class_count; ++c)
+            if (!done[c]) analyse(c);
+
+        valid = true;
+    }
+
+private:
+    size_t total_slots() const {
+        return results.empty() ? 0 : results.back().first_slot + results.back().slot_count;
+    }
+};
+
+} // namespace override_analysis
@@ -0,0 +1,115 @@
+#pragma once
+#include <ida.hpp>
+#include <segment.hpp>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include "memory_image.h"
+#include "vtable_utils.h"
+
+// Who points at X, for the whole image: every pointer-aligned word of every
+// loaded non-executable segment whose value lands inside the image, sorted by
+// target. Built once per refresh from the memory image, so discovery passes
+// do not depend on IDA having created data xrefs.
+
+namespace pointer_index {
+
+struct pointer_index_t {
+    std::vector<ea_t> targets;   // sorted
+    std::vector<ea_t> sources;   // sources[i] holds a pointer to targets[i]; ascending per target
+    bool valid = false;
+
+    // Needs memory_image::g_image loaded. Segments are swept in parallel.
+    void build() {
+        using namespace vtable_utils;
+        using memory_image::span_t;
+        clear();
+
+        const auto& img = memory_image::g_image;
+        if (!img.valid || img.segments.empty()) return;
+
+        const int ps = get_ptr_size();
+        const ea_t image_lo = img.segments.front().start_ea;
+        const ea_t image_span = img.segments.back().end_ea - image_lo;
+
+        std::vector<span_t> spans;
+        const size_t total = memory_image::collect_spans(ps, [](const memory_image::image_segment_t& s) {
+            return !(s.perm & SEGPERM_EXEC);
+        }, spans);
+
+        std::vector<std::vector<std::pair<ea_t, ea_t>>> chunks(parallel_chunks(total));
+        parallel_for(total, [&](size_t chunk, size_t begin, size_t end) {
+            auto& out = chunks[chunk];
+            memory_image::for_each_piece(spans, begin, end, [&](const span_t& sp, const uint8* base, size_t w, size_t stop) {
+                for (; w < stop; ++w) {
+                    ea_t v = 0;
+                    memcpy(&v, base + w * ps, ps);
+                    if ((v - image_lo) >= image_span) continue;  // cheap bounds test first
+                    if (img.is_mapped(v))
+                        out.emplace_back(v, sp.first_word + ea_t(w) * ps);
+                }
+            });
+            std::sort(out.begin(), out.end());
+        });
+
+        // Chunks are sorted; k-way merge straight into targets/sources with a
+        // min-heap of chunk cursors, O(n log chunks) and no intermediate copy
+        size_t pairs = 0;
+        for (const auto& c : chunks) pairs += c.size();
+        targets.reserve(pairs);
+        sources.reserve(pairs);
+
+        std::vector<std::pair<size_t, size_t>> heap;  // (chunk, position)
+        auto later = [&](const std::pair<size_t, size_t>& a, const std::pair<size_t, size_t>& b) {
+            return chunks[b.first][b.second] < chunks[a.first][a.second];
+        };
+        for (size_t c = 0; c < chunks.size(); ++c)
+            if (!chunks[c].empty()) heap.emplace_back(c, 0);
+        std::make_heap(heap.begin(), heap.end(), later);
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            auto& top = heap.back();
+            const auto& [t, src] = chunks[top.first][top.second];
+            targets.push_back(t);
+            sources.push_back(src);
+            if (++top.second < chunks[top.first].size()) std::push_heap(heap.begin(), heap.end(), later);
+            else heap.pop_back();
+        }
+        valid = true;
+    }
+
+    // fn(source) for each pointer to target, ascending; return false to stop
+    template<typename Fn>
+    void for_each_source(ea_t target, Fn&& fn) const {
+        auto it = std::lower_bound(targets.begin(), targets.end(), target);
+        for (size_t i = size_t(it - targets.begin()); i < targets.size() && targets[i] == target; ++i)
+            if (!fn(sources[i])) return;
+    }
+
+    size_t count(ea_t target) const {
+        auto range = std::equal_range(targets.begin(), targets.end(), target);
+        return size_t(range.second - range.first);
+    }
+
+    void clear() {
+        std::vector<ea_t>().swap(targets);
+        std::vector<ea_t>().swap(sources);
+        valid = false;
+    }
+
+    size_t memory_usage() const { return (targets.capacity() + sources.capacity()) * sizeof(ea_t); }
+};
+
+static pointer_index_t g_pointer_index;
+
+// Keeps g_pointer_index built for the lifetime of the scope (e.g. one find_vtables
+// run). Nested scopes reuse the outer index. Needs an image scope around it.
+struct index_scope_t {
+    bool owner;
+    index_scope_t() : owner(!g_pointer_index.valid) { if (owner) g_pointer_index.build(); }
+    ~index_scope_t() { if (owner) g_pointer_index.clear(); }
+    index_scope_t(const index_scope_t&) = delete;
+    index_scope_t& operator=(const index_scope_t&) = delete;
+};
+
+} // namespace pointer_index
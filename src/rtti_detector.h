@@ -3,12 +3,21 @@
 #include <idp.hpp>
 #include <name.hpp>
 #include <bytes.hpp>
+#include <segment.hpp>
+#include <vector>
+#include <algorithm>
+#include <climits>
 #include "vtable_utils.h"
 
 namespace rtti_detector {
 
 using vtable_utils::get_ptr_size;
 using vtable_utils::read_ptr;
+using vtable_utils::is_addr_mapped;
+using vtable_utils::read_byte;
+using vtable_utils::read_dword;
+using vtable_utils::read_qword;
+using vtable_utils::image_base;
 
 struct RTTIConfig {
     bool is_msvc = false;
@@ -17,7 +26,11 @@ struct RTTIConfig {
     bool detected = false;
 };
 
-static RTTIConfig g_config;
+inline bool same_config(const RTTIConfig& a, const RTTIConfig& b) {
+    return a.is_msvc == b.is_msvc && a.use_64bit_ptrs == b.use_64bit_ptrs && a.rtti_offset == b.rtti_offset;
+}
+
+static RTTIConfig g_config;  // lazy single-vtable guess, only used before a registry exists
 
 // Format detection
 inline bool is_pe_file() {
@@ -42,18 +55,18 @@ inline bool has_gcc_mangling(ea_t addr) {
 
 // MSVC COL validation
 inline bool validate_msvc_col(ea_t col_addr) {
-    if (!is_mapped(col_addr)) return false;
+    if (!is_addr_mapped(col_addr)) return false;
 
-    uint32 sig = get_dword(col_addr);
+    uint32 sig = read_dword(col_addr);
     if (sig > 2) return false;
 
     const int ptr_size = get_ptr_size();
-    int32 type_rva = get_dword(col_addr + 12);
-    int32 class_rva = get_dword(col_addr + 16);
+    int32 type_rva = read_dword(col_addr + 12);
+    int32 class_rva = read_dword(col_addr + 16);
 
     ea_t type_addr, class_addr;
     if (ptr_size == 8) {
-        ea_t base = get_imagebase();
+        ea_t base = image_base();
         if (base == BADADDR) return false;
         type_addr = base + type_rva;
         class_addr = base + class_rva;
@@ -62,71 +75,101 @@ inline bool validate_msvc_col(ea_t col_addr) {
         class_addr = class_rva;
     }
 
-    if (!is_mapped(type_addr) || !is_mapped(class_addr)) return false;
-    if (get_dword(class_addr) != 0) return false;
-    if (get_dword(class_addr + 8) > 64) return false;
+    if (!is_addr_mapped(type_addr) || !is_addr_mapped(class_addr)) return false;
+    if (read_dword(class_addr) != 0) return false;
+    if (read_dword(class_addr + 8) > 64) return false;
 
     return true;
 }
 
+// Offset of a vftable's subobject in the complete class, from the COL its
+// -ptr_size slot points at (COL +4). False when that slot holds no COL.
+inline bool msvc_vftable_offset(ea_t vftable, int32& offset) {
+    const int ptr_size = get_ptr_size();
+    ea_t col = read_ptr(vftable - ptr_size);
+    if (ptr_size == 8 && !(is_addr_mapped(col) && validate_msvc_col(col))) {
+        const ea_t base = image_base();
+        col = base != BADADDR ? base + read_dword(vftable - ptr_size) : BADADDR;
+    }
+    if (col == BADADDR || !validate_msvc_col(col)) return false;
+    offset = int32(read_dword(col + 4));
+    return true;
+}
+
 // GCC typeinfo validation
 inline bool validate_gcc_typeinfo(ea_t ti_addr) {
-    if (!is_mapped(ti_addr)) return false;
+    if (!is_addr_mapped(ti_addr)) return false;
 
     ea_t vtbl = read_ptr(ti_addr);
-    if (!is_mapped(vtbl)) return false;
+    if (!is_addr_mapped(vtbl)) return false;
 
     ea_t name = read_ptr(ti_addr + get_ptr_size());
-    if (!is_mapped(name)) return false;
+    if (!is_addr_mapped(name)) return false;
 
     char prefix[5] = {0};
     for (int i = 0; i < 4; i++) {
-        prefix[i] = get_byte(name + i);
+        prefix[i] = read_byte(name + i);
         if (!isprint(prefix[i]) && prefix[i] != '_') return false;
     }
     return strcmp(prefix, "_ZTS") == 0;
 }
 
-// MSVC x64: detect if using 64-bit pointers or 32-bit RVAs
-inline bool detect_msvc_64bit_ptr_format(ea_t vtable) {
-    ea_t base = get_imagebase();
-    if (base == BADADDR) return true;
+enum ptr_format_t { PTR_FORMAT_UNKNOWN, PTR_FORMAT_64, PTR_FORMAT_RVA };
 
-    ea_t ptr64 = get_qword(vtable - 8);
-    if (is_mapped(ptr64) && validate_msvc_col(ptr64)) return true;
+// MSVC x64: which form the COL pointer above the vtable takes, if either validates
+inline ptr_format_t probe_msvc_ptr_format(ea_t vtable) {
+    ea_t base = image_base();
+    if (base == BADADDR) return PTR_FORMAT_UNKNOWN;
 
-    uint32 rva = get_dword(vtable - 8);
-    if (is_mapped(base + rva) && validate_msvc_col(base + rva)) return false;
+    ea_t ptr64 = read_qword(vtable - 8);
+    if (is_addr_mapped(ptr64) && validate_msvc_col(ptr64)) return PTR_FORMAT_64;
 
-    return true;
+    uint32 rva = read_dword(vtable - 8);
+    if (is_addr_mapped(base + rva) && validate_msvc_col(base + rva)) return PTR_FORMAT_RVA;
+
+    return PTR_FORMAT_UNKNOWN;
 }
 
-// Find RTTI offset by probing common locations
-inline int detect_rtti_offset(ea_t vtable, bool is_msvc) {
-    static const int offsets[] = {-8, -16, 8, 0, 16, -24, 24};
+// MSVC x64: detect if using 64-bit pointers or 32-bit RVAs
+inline bool detect_msvc_64bit_ptr_format(ea_t vtable) {
+    return probe_msvc_ptr_format(vtable) != PTR_FORMAT_RVA;
+}
+
+static const int RTTI_PROBE_OFFSETS[] = {-8, -16, 8, 0, 16, -24, 24};
+constexpr size_t RTTI_PROBE_COUNT = sizeof(RTTI_PROBE_OFFSETS) / sizeof(RTTI_PROBE_OFFSETS[0]);
+
+// Index into RTTI_PROBE_OFFSETS of the first location holding valid RTTI, or -1
+inline int probe_rtti_offset(ea_t vtable, bool is_msvc) {
     const int ptr_size = get_ptr_size();
 
-    for (int off : offsets) {
+    for (size_t k = 0; k < RTTI_PROBE_COUNT; ++k) {
+        const int off = RTTI_PROBE_OFFSETS[k];
         ea_t probe = vtable + off;
-        if (!is_mapped(probe)) continue;
+        if (!is_addr_mapped(probe)) continue;
 
         if (is_msvc) {
-            ea_t col = (ptr_size == 8) ? get_qword(probe) : get_dword(probe);
-            if (is_mapped(col) && validate_msvc_col(col)) return off;
+            ea_t col = (ptr_size == 8) ? read_qword(probe) : read_dword(probe);
+            if (is_addr_mapped(col) && validate_msvc_col(col)) return int(k);
 
             if (ptr_size == 8) {
-                ea_t base = get_imagebase();
+                ea_t base = image_base();
                 if (base != BADADDR) {
-                    col = base + get_dword(probe);
-                    if (is_mapped(col) && validate_msvc_col(col)) return off;
+                    col = base + read_dword(probe);
+                    if (is_addr_mapped(col) && validate_msvc_col(col)) return int(k);
                 }
             }
         } else {
             ea_t ti = read_ptr(probe);
-            if (is_mapped(ti) && validate_gcc_typeinfo(ti)) return off;
+            if (is_addr_mapped(ti) && validate_gcc_typeinfo(ti)) return int(k);
         }
     }
-    return -8;
+    return -1;
+}
+
+// Find RTTI offset by probing common locations
+inline int detect_rtti_offset(ea_t vtable, bool is_msvc) {
+    const int k = probe_rtti_offset(vtable, is_msvc);
+    return k >= 0 ? RTTI_PROBE_OFFSETS[k] : -8;
 }
 
 // Main detection
@@ -142,11 +185,122 @@ inline RTTIConfig auto_detect(ea_t vtable) {
     return cfg;
 }
 
+// Tally of per-vtable detections; each field of the result is a majority vote
+struct config_vote_t {
+    int total = 0;
+    int msvc = 0;
+    int ptr64 = 0;
+    int ptr_rva = 0;
+    int offsets[RTTI_PROBE_COUNT] = {};
+
+    void add(ea_t vtable, bool pe) {
+        const bool is_msvc = has_msvc_mangling(vtable) || (!has_gcc_mangling(vtable) && pe);
+        ++total;
+        msvc += is_msvc;
+        if (is_msvc && get_ptr_size() == 8) {
+            const ptr_format_t f = probe_msvc_ptr_format(vtable);
+            ptr64 += f == PTR_FORMAT_64;
+            ptr_rva += f == PTR_FORMAT_RVA;
+        }
+        const int k = probe_rtti_offset(vtable, is_msvc);
+        if (k >= 0) ++offsets[k];
+    }
+
+    void merge(const config_vote_t& o) {
+        total += o.total;
+        msvc += o.msvc;
+        ptr64 += o.ptr64;
+        ptr_rva += o.ptr_rva;
+        for (size_t k = 0; k < RTTI_PROBE_COUNT; ++k) offsets[k] += o.offsets[k];
+    }
+
+    RTTIConfig result(bool pe) const {
+        RTTIConfig cfg;
+        cfg.is_msvc = msvc * 2 == total ? pe : msvc * 2 > total;
+        cfg.use_64bit_ptrs = cfg.is_msvc && get_ptr_size() == 8 && ptr_rva <= ptr64;
+        // Ties go to the earlier (more common) probe location
+        int best = -1;
+        for (size_t k = 0; k < RTTI_PROBE_COUNT; ++k)
+            if (offsets[k] && (best < 0 || offsets[k] > offsets[best])) best = int(k);
+        cfg.rtti_offset = best >= 0 ? RTTI_PROBE_OFFSETS[best] : -8;
+        cfg.detected = true;
+        return cfg;
+    }
+};
+
+// RTTI layout per segment, decided once per refresh by voting over a sample
+// of the vtables each segment holds. Adjacent segments that agree share one
+// interval; lookups are a binary search over the interval starts.
+struct config_registry_t {
+    struct region_t {
+        ea_t start;
+        ea_t end;
+        RTTIConfig cfg;
+    };
+
+    std::vector<region_t> regions;  // sorted, disjoint
+    RTTIConfig fallback;            // whole-database vote, for addresses outside every region
+    bool valid = false;
+
+    // Main thread only (names, segments). `vtables` must be sorted.
+    void build(const std::vector<ea_t>& vtables) {
+        using vtable_utils::CONFIG_VOTE_SAMPLE;
+        clear();
+
+        const bool pe = is_pe_file();
+        config_vote_t all;
+        for (size_t i = 0; i < vtables.size();) {
+            const segment_t* seg = getseg(vtables[i]);
+            if (!seg) { ++i; continue; }
+
+            size_t j = i;
+            while (j < vtables.size() && vtables[j] < seg->end_ea) ++j;
+
+            config_vote_t vote;
+            const size_t step = std::max<size_t>(1, (j - i) / CONFIG_VOTE_SAMPLE);
+            for (size_t k = i; k < j; k += step) vote.add(vtables[k], pe);
+            all.merge(vote);
+
+            const RTTIConfig cfg = vote.result(pe);
+            if (!regions.empty() && regions.back().end == seg->start_ea && same_config(regions.back().cfg, cfg))
+                regions.back().end = seg->end_ea;
+            else
+                regions.push_back({seg->start_ea, seg->end_ea, cfg});
+            i = j;
+        }
+
+        fallback = all.result(pe);
+        valid = true;
+    }
+
+    const RTTIConfig& find(ea_t ea) const {
+        auto it = std::upper_bound(regions.begin(), regions.end(), ea,
+                                   [](ea_t v, const region_t& r) { return v < r.start; });
+        if (it == regions.begin()) return fallback;
+        --it;
+        return ea < it->end ? it->cfg : fallback;
+    }
+
+    void clear() {
+        regions.clear();
+        fallback = RTTIConfig();
+        valid = false;
+    }
+};
+
+static config_registry_t g_config_registry;
+
+// Registry lookup once a refresh has built it. Before that, the first
+// vtable asked about decides for everything.
 inline const RTTIConfig& get_config(ea_t vtable) {
+    if (g_config_registry.valid) return g_config_registry.find(vtable);
     if (!g_config.detected) g_config = auto_detect(vtable);
     return g_config;
 }
 
-inline void reset_config() { g_config = RTTIConfig(); }
+inline void reset_config() {
+    g_config = RTTIConfig();
+    g_config_registry.clear();
+}
 
 } // namespace rtti_detector
@@ -6,17 +6,25 @@
 #include <demangle.hpp>
 #include <segment.hpp>
 #include <vector>
+#include <unordered_map>
 #include <string>
-#include <map>
 #include <algorithm>
 #include "vtable_utils.h"
 #include "rtti_detector.h"
+#include "name_parser.h"
+#include "class_pool.h"
+#include "string_reader.h"
 
 namespace rtti_parser {
 
 using vtable_utils::get_ptr_size;
 using vtable_utils::read_ptr;
 using vtable_utils::read_int32;
+using vtable_utils::is_addr_mapped;
+using vtable_utils::read_byte;
+using vtable_utils::read_dword;
+using vtable_utils::read_qword;
+using vtable_utils::image_base;
 
 struct BaseClassInfo {
     std::string class_name;
@@ -35,20 +43,20 @@ struct InheritanceInfo {
 namespace gcc_rtti {
 
 inline std::string read_string(ea_t addr) {
-    if (!is_mapped(addr)) return "";
-    std::string r;
-    r.reserve(128);
-    for (int i = 0; i < vtable_utils::MAX_RTTI_STRING_LENGTH; ++i) {
-        char c = get_byte(addr + i);
-        if (!c || (!isprint(c) && c != '_')) break;
-        r.push_back(c);
-    }
-    return r;
+    if (!is_addr_mapped(addr)) return "";
+    return string_reader::read_rtti_string(addr);
 }
 
 inline std::string extract_class_from_mangled(const std::string& m) {
     if (m.empty()) return "";
 
+    // Full <type> grammar (templates, substitutions) without the demangler;
+    // the hand parsers below still take truncated or unusual strings
+    char buf[name_parser::NAME_BUFFER_SIZE];
+    const bool special = m.compare(0, 4, "_ZTS") == 0 || m.compare(0, 4, "_ZTI") == 0;
+    if (const size_t n = name_parser::itanium_class(m, special ? std::string_view(m).substr(0, 4) : std::string_view(), buf, sizeof(buf)))
+        return std::string(buf, n);
+
     // _ZTS prefix
     if (m.compare(0, 4, "_ZTS") == 0 && m.length() > 4) {
         const char* p = m.c_str() + 4;
@@ -97,7 +105,7 @@ inline std::string extract_class_from_mangled(const std::string& m) {
 inline InheritanceInfo parse_gcc_typeinfo(ea_t ti_addr, const std::string& derived) {
     InheritanceInfo info;
     info.class_name = derived;
-    if (!is_mapped(ti_addr)) return info;
+    if (!is_addr_mapped(ti_addr)) return info;
 
     const int ps = get_ptr_size();
     ea_t vt = read_ptr(ti_addr);
@@ -110,13 +118,13 @@ inline InheritanceInfo parse_gcc_typeinfo(ea_t ti_addr, const std::string& deriv
 
     if (!got) {
         ea_t indirect = read_ptr(vt);
-        if (indirect != BADADDR && is_mapped(indirect))
+        if (indirect != BADADDR && is_addr_mapped(indirect))
             got = get_name(&vt_name, indirect);
 
         if (!got) {
             // Try to get base from structure
             ea_t base_ti = read_ptr(ti_addr + 2 * ps);
-            if (base_ti != BADADDR && is_mapped(base_ti)) {
+            if (base_ti != BADADDR && is_addr_mapped(base_ti)) {
                 ea_t bn = read_ptr(base_ti + ps);
                 if (bn != BADADDR) {
                     std::string bc = extract_class_from_mangled(read_string(bn));
@@ -151,12 +159,14 @@ inline InheritanceInfo parse_gcc_typeinfo(ea_t ti_addr, const std::string& deriv
     // Multiple/virtual inheritance
     else if (strstr(n, "__vmi_class_type_info")) {
         info.has_multiple_inheritance = true;
+        // unsigned flags, unsigned base_count, then the base array: +8/+12/+16
+        // on 32-bit, +16/+20/+24 on LP64
         int32 flags = read_int32(ti_addr + 2 * ps);
-        int32 cnt = read_int32(ti_addr + 3 * ps);
+        int32 cnt = read_int32(ti_addr + 2 * ps + 4);
         if (flags & 1) info.has_virtual_inheritance = true;
 
         if (cnt > 0 && cnt < 32) {
-            ea_t arr = ti_addr + 4 * ps;
+            ea_t arr = ti_addr + 2 * ps + 8;
             for (int32 i = 0; i < cnt; ++i) {
                 ea_t entry = arr + (i * 2 * ps);
                 ea_t base_ti = read_ptr(entry);
@@ -191,23 +201,84 @@ inline ea_t rva_to_va(ea_t base, int32 rva) {
     return rva ? base + rva : BADADDR;
 }
 
-inline std::string read_msvc_type_name(ea_t td) {
-    if (!is_mapped(td)) return "";
+// One BaseClassDescriptor as kept by the hierarchy cache
+struct bcd_record_t {
+    ea_t td;
+    int32 mdisp;
+    bool is_virtual;
+    bool primary;  // BCD array index 0, the class itself
+};
+
+// TypeDescriptor names and ClassHierarchyDescriptor base arrays, each decoded
+// once per refresh and shared by every COL that points at them. Main thread only.
+struct rtti_graph_t {
+    struct chd_t {
+        uint32 attrs;
+        uint32 first;  // into bcds
+        uint32 count;
+    };
+
+    string_reader::string_memo_t type_names;  // TD -> read_msvc_type_name() result
+    std::unordered_map<ea_t, chd_t> hierarchies;
+    std::vector<bcd_record_t> bcds;
+
+    // Decodes the CHD at `cd` on first use
+    const chd_t& hierarchy(ea_t cd, bool x64, ea_t base) {
+        auto it = hierarchies.find(cd);
+        if (it != hierarchies.end()) return it->second;
+
+        chd_t h{read_dword(cd + 4), uint32(bcds.size()), 0};
+        const uint32 num = read_dword(cd + 8);
+        const int32 arr_rva = read_dword(cd + 12);
+        const ea_t arr = x64 ? rva_to_va(base, arr_rva) : arr_rva;
+
+        if (num && num <= 64 && arr != BADADDR && is_addr_mapped(arr)) {
+            for (uint32 i = 0; i < num; ++i) {
+                int32 bcd_rva = read_dword(arr + i * 4);
+                ea_t bcd = x64 ? rva_to_va(base, bcd_rva) : bcd_rva;
+                if (bcd == BADADDR || !is_addr_mapped(bcd)) continue;
+
+                int32 btd_rva = read_dword(bcd);
+                ea_t btd = x64 ? rva_to_va(base, btd_rva) : btd_rva;
+                if (btd == BADADDR || !is_addr_mapped(btd)) continue;
+
+                bcds.push_back({btd, int32(read_dword(bcd + 8)), int32(read_dword(bcd + 16)) != -1, i == 0});
+            }
+        }
+        h.count = uint32(bcds.size()) - h.first;
+        return hierarchies.emplace(cd, h).first->second;
+    }
 
+    void clear() {
+        type_names.clear();
+        hierarchies.clear();
+        bcds.clear();
+    }
+
+    size_t memory_usage() const {
+        return type_names.memory_usage() + bcds.capacity() * sizeof(bcd_record_t) +
+               hierarchies.size() * (sizeof(ea_t) + sizeof(chd_t) + 2 * sizeof(void*));
+    }
+};
+
+static rtti_graph_t g_graph;
+
+inline std::string decode_msvc_type_name(ea_t td) {
     const int ps = get_ptr_size();
     ea_t name_addr = td + 2 * ps;
 
-    std::string raw;
-    raw.reserve(128);
-    for (int i = 0; i < vtable_utils::MAX_RTTI_STRING_LENGTH; ++i) {
-        char c = get_byte(name_addr + i);
-        if (!c || (!isprint(c) && c != '_')) break;
-        raw.push_back(c);
-    }
+    const std::string raw = string_reader::read_rtti_string(name_addr);
 
     const char* to_dem = raw.c_str();
     if (!raw.empty() && raw[0] == '.') to_dem++;
 
+    // .?AV / .?AU without templates parse directly to what the demangler would give
+    char buf[name_parser::NAME_BUFFER_SIZE];
+    if (size_t n = name_parser::msvc_type_class(raw, buf, sizeof(buf))) {
+        n = clean_msvc_decorated_name(std::string_view(buf, n), buf);
+        return normalize_msvc_nested_class(std::string_view(buf, n));
+    }
+
     qstring dem;
     if (demangle_name(&dem, to_dem, MNG_NODEFINIT) > 0 && dem.length() > 0) {
         std::string s = dem.c_str();
@@ -232,60 +303,50 @@ inline std::string read_msvc_type_name(ea_t td) {
     return normalize_msvc_nested_class(raw);
 }
 
+inline std::string read_msvc_type_name(ea_t td) {
+    if (!is_addr_mapped(td)) return "";
+    std::string name;
+    if (g_graph.type_names.find(td, name)) return name;
+    name = decode_msvc_type_name(td);
+    g_graph.type_names.put(td, name);
+    return name;
+}
+
 inline InheritanceInfo parse_msvc_col(ea_t col, const std::string& derived) {
     InheritanceInfo info;
     info.class_name = derived;
-    if (!is_mapped(col)) return info;
+    if (!is_addr_mapped(col)) return info;
 
     const int ps = get_ptr_size();
     const bool x64 = (ps == 8);
 
-    uint32 sig = get_dword(col);
+    uint32 sig = read_dword(col);
     if (sig > 2) return info;
 
-    int32 type_rva = get_dword(col + 12);
-    int32 class_rva = get_dword(col + 16);
+    int32 type_rva = read_dword(col + 12);
+    int32 class_rva = read_dword(col + 16);
 
-    ea_t base = x64 ? get_imagebase() : 0;
+    ea_t base = x64 ? image_base() : 0;
     if (x64 && base == BADADDR) return info;
 
     ea_t td = x64 ? rva_to_va(base, type_rva) : type_rva;
     ea_t cd = x64 ? rva_to_va(base, class_rva) : class_rva;
     if (td == BADADDR || cd == BADADDR) return info;
 
-    uint32 attrs = get_dword(cd + 4);
-    uint32 num = get_dword(cd + 8);
-    int32 arr_rva = get_dword(cd + 12);
-
-    info.has_multiple_inheritance = (attrs & 1) != 0;
-    info.has_virtual_inheritance = (attrs & 2) != 0;
-    if (!num || num > 64) return info;
-
-    ea_t arr = x64 ? rva_to_va(base, arr_rva) : arr_rva;
-    if (arr == BADADDR || !is_mapped(arr)) return info;
-
-    for (uint32 i = 0; i < num; ++i) {
-        int32 bcd_rva = get_dword(arr + i * 4);
-        ea_t bcd = x64 ? rva_to_va(base, bcd_rva) : bcd_rva;
-        if (bcd == BADADDR || !is_mapped(bcd)) continue;
-
-        int32 btd_rva = get_dword(bcd);
-        int32 mdisp = get_dword(bcd + 8);
-        int32 vdisp = get_dword(bcd + 16);
+    const rtti_graph_t::chd_t& h = g_graph.hierarchy(cd, x64, base);
+    info.has_multiple_inheritance = (h.attrs & 1) != 0;
+    info.has_virtual_inheritance = (h.attrs & 2) != 0;
 
-        ea_t btd = x64 ? rva_to_va(base, btd_rva) : btd_rva;
-        if (btd == BADADDR || !is_mapped(btd)) continue;
+    for (uint32 i = 0; i < h.count; ++i) {
+        const bcd_record_t& b = g_graph.bcds[h.first + i];
+        std::string bc = read_msvc_type_name(b.td);
+        if (bc.empty() || bc == derived || b.primary) continue;
 
-        std::string bc = read_msvc_type_name(btd);
-        if (bc.empty() || bc == derived) continue;
-
-        if (i > 0) {
-            BaseClassInfo b;
-            b.class_name = bc;
-            b.offset = mdisp;
-            b.is_virtual = (vdisp != -1);
-            info.base_classes.push_back(b);
-        }
+        BaseClassInfo info_base;
+        info_base.class_name = std::move(bc);
+        info_base.offset = b.mdisp;
+        info_base.is_virtual = b.is_virtual;
+        info.base_classes.push_back(std::move(info_base));
     }
     return info;
 }
@@ -297,15 +358,15 @@ inline InheritanceInfo parse_msvc_rtti(ea_t vt, const rtti_detector::RTTIConfig&
     const int ps = get_ptr_size();
 
     ea_t rtti = vt + cfg.rtti_offset;
-    if (!is_mapped(rtti)) return info;
+    if (!is_addr_mapped(rtti)) return info;
 
     ea_t col;
     if (ps == 8) {
-        col = cfg.use_64bit_ptrs ? get_qword(rtti) : msvc_rtti::rva_to_va(get_imagebase(), get_dword(rtti));
+        col = cfg.use_64bit_ptrs ? read_qword(rtti) : msvc_rtti::rva_to_va(image_base(), read_dword(rtti));
     } else {
-        col = get_dword(rtti);
+        col = read_dword(rtti);
     }
-    if (col == BADADDR || !is_mapped(col)) return info;
+    if (col == BADADDR || !is_addr_mapped(col)) return info;
 
     std::string cls;
     qstring n;
@@ -340,7 +401,7 @@ inline InheritanceInfo parse_gcc_rtti(ea_t vt, const rtti_detector::RTTIConfig&)
     }
 
     for (int i = 0; i < 3; ++i) {
-        if (candidates[i] == BADADDR || !is_mapped(candidates[i])) continue;
+        if (candidates[i] == BADADDR || !is_addr_mapped(candidates[i])) continue;
         InheritanceInfo ti = gcc_rtti::parse_gcc_typeinfo(candidates[i], cls);
         if (!ti.base_classes.empty()) return ti;
         if (i == 2) info = ti;
@@ -353,15 +414,157 @@ inline InheritanceInfo parse_vtable_rtti(ea_t vt) {
     return cfg.is_msvc ? parse_msvc_rtti(vt, cfg) : parse_gcc_rtti(vt, cfg);
 }
 
-static std::map<ea_t, InheritanceInfo> g_rtti_cache;
+// One base class of a cached record; the name is a class pool ID
+struct base_record_t {
+    ea_t vtable_addr;
+    int32 offset;
+    class_pool::class_id_t class_id;
+    bool is_virtual;
+};
+
+enum rtti_flags_t : uint8 {
+    RTTI_MULTIPLE = 1 << 0,
+    RTTI_VIRTUAL  = 1 << 1,
+};
+
+struct rtti_record_t {
+    ea_t vtable;
+    class_pool::class_id_t class_id;
+    uint32 first_base;  // into rtti_cache_t::bases
+    uint32 base_count;
+    uint8 flags;
+
+    bool has_multiple_inheritance() const { return (flags & RTTI_MULTIPLE) != 0; }
+    bool has_virtual_inheritance() const { return (flags & RTTI_VIRTUAL) != 0; }
+};
+
+// Parsed RTTI for every vtable: records sorted by vtable EA, their base
+// classes back to back in one arena. fill() appends a sorted batch; single
+// misses are inserted in place. Forgotten records leave their bases behind
+// until enough garbage builds up to compact.
+struct rtti_cache_t {
+    std::vector<rtti_record_t> records;
+    std::vector<base_record_t> bases;
+    size_t dead_bases = 0;
+
+    struct base_range_t {
+        const base_record_t* first;
+        const base_record_t* last;
+        const base_record_t* begin() const { return first; }
+        const base_record_t* end() const { return last; }
+        size_t size() const { return size_t(last - first); }
+        bool empty() const { return first == last; }
+    };
+
+    base_range_t bases_of(const rtti_record_t& r) const {
+        const base_record_t* b = bases.data() + r.first_base;
+        return {b, b + r.base_count};
+    }
+
+    const rtti_record_t* find(ea_t vt) const {
+        auto it = lower_bound(vt);
+        return it != records.end() && it->vtable == vt ? &*it : nullptr;
+    }
+
+    // Parses on a miss. The reference is valid until the next insertion.
+    const rtti_record_t& get(ea_t vt) {
+        auto it = lower_bound(vt);
+        if (it != records.end() && it->vtable == vt) return *it;
+        const rtti_record_t rec = make_record(vt, parse_vtable_rtti(vt));
+        return *records.insert(it, rec);
+    }
+
+    // Parses every listed vtable not cached yet; `sorted` must be ascending
+    void fill(const std::vector<ea_t>& sorted) {
+        if (records.empty()) {
+            records.reserve(sorted.size());
+            for (ea_t vt : sorted) records.push_back(make_record(vt, parse_vtable_rtti(vt)));
+            return;
+        }
+        for (ea_t vt : sorted) get(vt);
+    }
+
+    // Appends a record loaded from elsewhere; calls must come in ascending EA order
+    bool append(ea_t vt, class_pool::class_id_t class_id, uint8 flags, const std::vector<base_record_t>& record_bases) {
+        if (!records.empty() && records.back().vtable >= vt) return false;
+        records.push_back({vt, class_id, uint32(bases.size()), uint32(record_bases.size()), flags});
+        bases.insert(bases.end(), record_bases.begin(), record_bases.end());
+        return true;
+    }
+
+    void forget(ea_t vt) {
+        auto it = lower_bound(vt);
+        if (it == records.end() || it->vtable != vt) return;
+        dead_bases += it->base_count;
+        records.erase(it);
+        if (dead_bases > bases.size() / 2) compact();
+    }
+
+    void clear() {
+        records.clear();
+        bases.clear();
+        dead_bases = 0;
+    }
+
+    size_t memory_usage() const {
+        return records.capacity() * sizeof(rtti_record_t) + bases.capacity() * sizeof(base_record_t);
+    }
+
+private:
+    std::vector<rtti_record_t>::iterator lower_bound(ea_t vt) {
+        return std::lower_bound(records.begin(), records.end(), vt,
+                                [](const rtti_record_t& r, ea_t v) { return r.vtable < v; });
+    }
+
+    std::vector<rtti_record_t>::const_iterator lower_bound(ea_t vt) const {
+        return std::lower_bound(records.begin(), records.end(), vt,
+                                [](const rtti_record_t& r, ea_t v) { return r.vtable < v; });
+    }
+
+    rtti_record_t make_record(ea_t vt, const InheritanceInfo& info) {
+        rtti_record_t rec;
+        rec.vtable = vt;
+        rec.class_id = info.class_name.empty() ? class_pool::NO_CLASS : class_pool::intern(info.class_name);
+        rec.first_base = uint32(bases.size());
+        rec.base_count = uint32(info.base_classes.size());
+        rec.flags = uint8((info.has_multiple_inheritance ? RTTI_MULTIPLE : 0) |
+                          (info.has_virtual_inheritance ? RTTI_VIRTUAL : 0));
+        for (const auto& b : info.base_classes)
+            bases.push_back({b.vtable_addr, int32(b.offset), class_pool::intern(b.class_name), b.is_virtual});
+        return rec;
+    }
+
+    void compact() {
+        std::vector<base_record_t> live;
+        live.reserve(bases.size() - dead_bases);
+        for (auto& r : records) {
+            const uint32 first = uint32(live.size());
+            live.insert(live.end(), bases.begin() + r.first_base, bases.begin() + r.first_base + r.base_count);
+            r.first_base = first;
+        }
+        bases.swap(live);
+        dead_bases = 0;
+    }
+};
+
+static rtti_cache_t g_rtti_cache;
 
-inline const InheritanceInfo& get_inheritance_info(ea_t vt) {
-    auto it = g_rtti_cache.find(vt);
-    if (it != g_rtti_cache.end()) return it->second;
-    g_rtti_cache[vt] = parse_vtable_rtti(vt);
-    return g_rtti_cache[vt];
+inline const rtti_record_t& get_inheritance_info(ea_t vt) { return g_rtti_cache.get(vt); }
+
+// Everything derived from database bytes below the per-vtable records
+inline void clear_decode_caches() {
+    msvc_rtti::g_graph.clear();
+    string_reader::g_string_memo.clear();
+}
+
+inline void clear_rtti_cache() {
+    g_rtti_cache.clear();
+    clear_decode_caches();
 }
 
-inline void clear_rtti_cache() { g_rtti_cache.clear(); }
+inline size_t decode_cache_bytes() {
+    return msvc_rtti::g_graph.memory_usage() + string_reader::g_string_memo.memory_usage();
+}
+inline void forget_rtti(ea_t vt) { g_rtti_cache.forget(vt); }
 
 } // namespace rtti_parser
@@ -8,13 +8,20 @@
 #include <auto.hpp>
 #include <vector>
 #include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+#include <iterator>
 #include "vtable_utils.h"
 #include "rtti_detector.h"
+#include "thunk_resolver.h"
 
 namespace smart_annotator {
 
 using vtable_utils::get_ptr_size;
 using vtable_utils::read_ptr;
+using vtable_utils::is_addr_mapped;
+using vtable_utils::is_exec_addr;
+using vtable_utils::read_byte;
 using vtable_utils::OPCODE_PUSH_RBP;
 using vtable_utils::OPCODE_REX_W;
 using vtable_utils::OPCODE_REX;
@@ -29,50 +36,118 @@ inline int detect_vfunc_start_offset(ea_t vtable_addr, bool) {
     const int ptr_size = get_ptr_size();
     for (int i = 0; i < MAX_VFUNC_SEARCH_DEPTH; ++i) {
         ea_t entry = vtable_addr + (i * ptr_size);
-        if (!is_mapped(entry)) continue;
+        if (!is_addr_mapped(entry)) continue;
 
-        segment_t* seg = getseg(read_ptr(entry));
-        if (seg && (seg->perm & SEGPERM_EXEC)) return i;
+        ea_t target = read_ptr(entry);
+        if (target != BADADDR && is_exec_addr(target)) return i;
     }
 
     // GCC/Itanium: [offset-to-top, typeinfo*, vfuncs...]
     return (config.rtti_offset < 0) ? 2 : DEFAULT_VFUNC_START_OFFSET;
 }
 
+enum symbol_flags_t : uint8 {
+    SYM_PURE_VIRTUAL = 1 << 0,  // __cxa_pure_virtual / _purecall / purevirt
+    SYM_TYPEINFO     = 1 << 1,  // _ZTI* / *typeinfo*
+    SYM_FUNC_NAME    = 1 << 2,  // sub_ / nullsub_ / j_ thunks / *_vfunc_*
+};
+
+inline uint8 classify_symbol_name(const char* n) {
+    uint8 f = 0;
+    if (strstr(n, "__cxa_pure_virtual") || strstr(n, "_purecall") || strstr(n, "purevirt"))
+        f |= SYM_PURE_VIRTUAL;
+    if (strstr(n, "_ZTI") || strstr(n, "typeinfo"))
+        f |= SYM_TYPEINFO;
+    if (strncmp(n, "sub_", 4) == 0 || strncmp(n, "nullsub_", 8) == 0 ||
+        strncmp(n, "j_", 2) == 0 || strstr(n, "_vfunc_"))
+        f |= SYM_FUNC_NAME;
+    return f;
+}
+
+// Addresses whose names the slot scanner cares about, resolved in one pass over
+// the name list instead of get_name() + substring search per slot. Kept current
+// through the IDB rename hook.
+struct symbol_index_t {
+    std::unordered_map<ea_t, uint8> flags;
+    bool valid = false;
+
+    void build(const vtable_utils::name_snapshot_t& names) {
+        using namespace vtable_utils;
+
+        std::vector<std::vector<std::pair<ea_t, uint8>>> chunks(parallel_chunks(names.size()));
+        parallel_for(names.size(), [&](size_t chunk, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                uint8 f = classify_symbol_name(names.name(i));
+                if (f) chunks[chunk].emplace_back(names.ea(i), f);
+            }
+        });
+
+        flags.clear();
+        for (const auto& c : chunks)
+            for (const auto& [ea, f] : c) flags[ea] |= f;
+        valid = true;
+    }
+
+    // Returns true when the rename changed how scans classify ea
+    bool on_rename(ea_t ea, const char* new_name) {
+        if (!valid) return false;
+        uint8 f = (new_name && *new_name) ? classify_symbol_name(new_name) : 0;
+        const uint8 old = lookup(ea);
+        if (f) flags[ea] = f;
+        else flags.erase(ea);
+        return f != old;
+    }
+
+    uint8 lookup(ea_t ea) const {
+        auto it = flags.find(ea);
+        return it != flags.end() ? it->second : 0;
+    }
+
+    void clear() {
+        flags.clear();
+        valid = false;
+    }
+};
+
+static symbol_index_t g_symbol_index;
+
 inline bool is_pure_virtual(ea_t func) {
     if (!func || func == BADADDR) return false;
+    if (g_symbol_index.valid) return (g_symbol_index.lookup(func) & SYM_PURE_VIRTUAL) != 0;
+
     qstring name;
     if (!get_name(&name, func)) return false;
-    return name.find("__cxa_pure_virtual") != qstring::npos ||
-           name.find("_purecall") != qstring::npos ||
-           name.find("purevirt") != qstring::npos;
+    return (classify_symbol_name(name.c_str()) & SYM_PURE_VIRTUAL) != 0;
 }
 
 inline bool is_typeinfo(ea_t ptr) {
+    if (g_symbol_index.valid) return (g_symbol_index.lookup(ptr) & SYM_TYPEINFO) != 0;
+
     qstring name;
-    return get_name(&name, ptr) &&
-           (name.find("_ZTI") != qstring::npos || name.find("typeinfo") != qstring::npos);
+    return get_name(&name, ptr) && (classify_symbol_name(name.c_str()) & SYM_TYPEINFO) != 0;
 }
 
-inline bool is_valid_func_ptr(ea_t addr) {
-    if (!addr || addr == BADADDR || !is_mapped(addr)) return false;
-
-    segment_t* seg = getseg(addr);
-    if (!seg || !(seg->perm & SEGPERM_EXEC)) return false;
+// is_valid_func_ptr() for an address already known to be in an executable segment
+inline bool is_valid_exec_target(ea_t addr) {
     if (is_code(get_flags(addr))) return true;
 
-    qstring name;
-    if (get_name(&name, addr)) {
-        const char* n = name.c_str();
-        if (strncmp(n, "sub_", 4) == 0 || strncmp(n, "nullsub_", 8) == 0 ||
-            strncmp(n, "j_", 2) == 0 || strstr(n, "_vfunc_"))
+    if (g_symbol_index.valid) {
+        if (g_symbol_index.lookup(addr) & SYM_FUNC_NAME) return true;
+    } else {
+        qstring name;
+        if (get_name(&name, addr) && (classify_symbol_name(name.c_str()) & SYM_FUNC_NAME))
             return true;
     }
 
-    uint8 b = get_byte(addr);
+    uint8 b = read_byte(addr);
     return b == OPCODE_PUSH_RBP || b == OPCODE_REX_W || b == OPCODE_REX || b == OPCODE_REX_B;
 }
 
+inline bool is_valid_func_ptr(ea_t addr) {
+    if (!addr || addr == BADADDR || !is_exec_addr(addr)) return false;
+    return is_valid_exec_target(addr);
+}
+
 inline ea_t find_next_vtable(ea_t current, const std::vector<ea_t>& sorted) {
     auto it = std::upper_bound(sorted.begin(), sorted.end(), current);
     return (it != sorted.end()) ? *it : BADADDR;
@@ -85,54 +160,542 @@ struct VTableEntry {
     bool is_pure_virtual;
 };
 
+// Raw slot pointers of one vtable region plus the cheap executable-range test.
+// Reusing a block across decode_slots() calls reuses its buffers too.
+struct slot_block_t {
+    std::vector<ea_t> ptrs;
+    std::vector<uint8> exec;
+    std::vector<uint8> scratch;                     // bytes, when no image is loaded
+    std::vector<memory_image::addr_range_t> ranges;  // exec ranges, when no image is loaded
+};
+
+// One bulk read for `count` slots from `first` (stops at unmapped memory), then a
+// branch-free range check of every pointer against the executable segment table.
+// The inner loops have no calls or early exits so the compiler can vectorize them.
+inline void decode_slots(ea_t first, int count, slot_block_t& out) {
+    out.ptrs.clear();
+    out.exec.clear();
+    if (count <= 0) return;
+
+    const int ptr_size = get_ptr_size();
+    size_t got = 0;
+    const uint8* raw = vtable_utils::read_mapped_span(first, size_t(count) * ptr_size, out.scratch, &got);
+
+    const size_t n = got / ptr_size;
+    out.ptrs.resize(n);
+    if (ptr_size == 8) {
+        for (size_t i = 0; i < n; ++i) {
+            uint64 v;
+            memcpy(&v, raw + i * 8, 8);
+            out.ptrs[i] = ea_t(v);
+        }
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            uint32 v;
+            memcpy(&v, raw + i * 4, 4);
+            out.ptrs[i] = ea_t(v);
+        }
+    }
+
+    const auto& ranges = vtable_utils::get_exec_ranges(out.ranges);
+    out.exec.assign(n, 0);
+    const ea_t* ptrs = out.ptrs.data();
+    uint8* exec = out.exec.data();
+    for (const auto& r : ranges) {
+        const ea_t lo = r.start_ea;
+        const ea_t span = r.end_ea - r.start_ea;
+        for (size_t i = 0; i < n; ++i)
+            exec[i] |= uint8((ptrs[i] - lo) < span);
+    }
+}
+
+// A slot pointer scan_vtable() would count, given decode_slots()' range test
+inline bool is_slot_target(ea_t ptr, bool exec) {
+    if (!ptr || ptr == BADADDR) return false;
+    if (exec) return is_pure_virtual(ptr) || is_valid_exec_target(ptr);
+    return is_addr_mapped(ptr) && is_pure_virtual(ptr);
+}
+
+inline int64 signed_word(ea_t v, int ptr_size) {
+    return ptr_size == 8 ? int64(uint64(v)) : int64(int32(uint32(v)));
+}
+
+// Vtable groups: every vtable of one class object. An Itanium _ZTV symbol (or
+// a _ZTC construction vtable) covers the primary vtable followed by one vtable
+// per secondary base subobject, each behind its own [vcall/vbase offsets...,
+// offset-to-top, typeinfo] header; one forward pass over the group's words
+// splits it. MSVC emits a separate vftable per base subobject, each behind its
+// own COL pointer. Slot scans stop at the next subobject header, so no vtable
+// counts the slots of the one after it.
+
+enum group_kind_t : uint8 {
+    GROUP_ITANIUM,
+    GROUP_CONSTRUCTION,  // _ZTC
+    GROUP_MSVC,
+};
+
+struct subobject_vtable_t {
+    ea_t header;          // first header word (MSVC: the COL pointer)
+    ea_t address;         // address point, the first slot
+    int64 offset;         // subobject offset in the complete object
+    uint32 slot_count;    // valid slots
+};
+
+struct vtable_group_t {
+    ea_t start;           // the primary vtable's symbol address
+    int max_words;        // Itanium decode limit: next known vtable or group symbol
+    uint32 first;         // into group_table_t::subobjects, primary first
+    uint32 count;
+    group_kind_t kind;
+};
+
+// One class's MSVC vftables as find_vtables() reported them
+struct vftable_set_t {
+    ea_t primary;
+    const std::vector<ea_t>* others;
+};
+
+struct group_table_t {
+    std::vector<vtable_group_t> groups;  // by start
+    std::vector<subobject_vtable_t> subobjects;
+    std::vector<ea_t> headers;           // secondary subobject headers, sorted
+    size_t dead_subobjects = 0;          // left behind by redecode(), reclaimed by compact()
+    slot_block_t block;                  // decode buffer shared by every decode()/count_slots()
+    bool valid = false;
+
+    // Header of a secondary vtable starting at word i: offset words (vcall/vbase
+    // offsets), then a non-zero negative offset-to-top, the group's typeinfo (or
+    // any named one, as construction groups mix them) and a slot. Index of the
+    // offset-to-top word, SIZE_MAX when there is none.
+    static size_t find_header(const slot_block_t& b, size_t i, ea_t typeinfo, int ps) {
+        using vtable_utils::MAX_SUBOBJECT_OFFSET;
+        const size_t n = b.ptrs.size();
+        for (size_t j = i; j + 2 < n && j <= i + vtable_utils::MAX_VCALL_OFFSETS; ++j) {
+            const int64 v = signed_word(b.ptrs[j], ps);
+            if (v >= MAX_SUBOBJECT_OFFSET || v <= -MAX_SUBOBJECT_OFFSET) return SIZE_MAX;
+            if (v >= 0 || v % ps) continue;
+
+            const ea_t ti = b.ptrs[j + 1];
+            if (ti != typeinfo && !(ti && is_typeinfo(ti))) continue;
+            if (is_slot_target(b.ptrs[j + 2], b.exec[j + 2])) return j;
+        }
+        return SIZE_MAX;
+    }
+
+    // Splits the Itanium group at start into subobject vtables, appended to
+    // `subobjects`; slot targets of the secondary ones go to `targets`
+    bool decode(ea_t start, int max_words, group_kind_t kind, vtable_group_t& g, std::vector<ea_t>& targets) {
+        using namespace vtable_utils;
+        const int ps = get_ptr_size();
+        const int ap = detect_vfunc_start_offset(start, false);
+        if (ap < 2 || max_words <= ap) return false;  // no offset-to-top/typeinfo header
+
+        decode_slots(start, std::min(max_words, MAX_GROUP_WORDS), block);
+        const size_t n = block.ptrs.size();
+        if (n <= size_t(ap)) return false;
+
+        const ea_t typeinfo = block.ptrs[ap - 1];
+        g = {start, max_words, uint32(subobjects.size()), 0, kind};
+
+        size_t header = 0, first_slot = size_t(ap);
+        int64 ott = signed_word(block.ptrs[ap - 2], ps);
+        for (;;) {
+            size_t i = first_slot, next = SIZE_MAX;
+            uint32 valid = 0;
+            for (int invalid = 0; i < n && invalid < CONSECUTIVE_INVALID_THRESHOLD; ++i) {
+                if (is_slot_target(block.ptrs[i], block.exec[i])) {
+                    ++valid;
+                    invalid = 0;
+                    if (g.count) targets.push_back(block.ptrs[i]);
+                } else if ((next = find_header(block, i, typeinfo, ps)) != SIZE_MAX) {
+                    break;
+                } else {
+                    ++invalid;
+                }
+            }
+
+            subobjects.push_back({start + ea_t(header) * ps, start + ea_t(first_slot) * ps, -ott, valid});
+            ++g.count;
+            if (next == SIZE_MAX) break;
+
+            header = i;
+            ott = signed_word(block.ptrs[next], ps);
+            first_slot = next + 2;
+        }
+        return true;
+    }
+
+    // Valid slots of a vftable within `words`, counted as scan_vtable() does
+    uint32 count_slots(ea_t address, int words, std::vector<ea_t>& targets) {
+        decode_slots(address, words, block);
+        uint32 valid = 0;
+        int invalid = 0;
+        for (size_t k = 0; k < block.ptrs.size() && invalid < vtable_utils::CONSECUTIVE_INVALID_THRESHOLD; ++k) {
+            if (is_slot_target(block.ptrs[k], block.exec[k])) {
+                ++valid;
+                invalid = 0;
+                targets.push_back(block.ptrs[k]);
+            } else {
+                ++invalid;
+            }
+        }
+        return valid;
+    }
+
+    // Groups of the given Itanium vtables (sorted), of every _ZTC symbol and of
+    // the MSVC classes with more than one vftable. Itanium groups are decoded up
+    // to the next vtable, construction vtable or VTT. Secondary slot targets
+    // prime the thunk cache in the same pass.
+    void build(const vtable_utils::name_snapshot_t& names, const std::vector<ea_t>& itanium,
+               const std::vector<vftable_set_t>& msvc, const std::vector<ea_t>& sorted_vtables) {
+        using vtable_utils::MAX_GROUP_WORDS;
+        clear();
+        std::vector<ea_t> construction;
+        std::vector<ea_t> bounds(sorted_vtables);
+        for (size_t i = 0; i < names.size(); ++i) {
+            const char* name = names.name(i);
+            if (strncmp(name, "_ZTC", 4) == 0) construction.push_back(names.ea(i));
+            else if (strncmp(name, "_ZTT", 4) != 0) continue;
+            bounds.push_back(names.ea(i));
+        }
+        std::sort(construction.begin(), construction.end());
+        construction.erase(std::unique(construction.begin(), construction.end()), construction.end());
+        std::sort(bounds.begin(), bounds.end());
+
+        std::vector<ea_t> starts;
+        std::merge(itanium.begin(), itanium.end(), construction.begin(), construction.end(),
+                   std::back_inserter(starts));
+        starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+
+        const int ps = get_ptr_size();
+        std::vector<ea_t> targets;
+        groups.reserve(starts.size() + msvc.size());
+        for (ea_t s : starts) {
+            auto next = std::upper_bound(bounds.begin(), bounds.end(), s);
+            const int max_words = next == bounds.end() ? MAX_GROUP_WORDS
+                                                       : int(std::min<ea_t>((*next - s) / ps, MAX_GROUP_WORDS));
+            const bool ctor = std::binary_search(construction.begin(), construction.end(), s);
+            vtable_group_t g;
+            if (decode(s, max_words, ctor ? GROUP_CONSTRUCTION : GROUP_ITANIUM, g, targets))
+                groups.push_back(g);
+        }
+
+        // MSVC: the primary, then the others by subobject offset; slots are
+        // counted once every header is known
+        for (const auto& set : msvc) {
+            const uint32 first = uint32(subobjects.size());
+            subobjects.push_back({set.primary - ps, set.primary, 0, 0});
+            for (ea_t vt : *set.others) {
+                int32 offset = 0;
+                if (rtti_detector::msvc_vftable_offset(vt, offset) && offset != 0)
+                    subobjects.push_back({vt - ps, vt, offset, 0});
+            }
+            std::sort(subobjects.begin() + first + 1, subobjects.end(),
+                      [](const subobject_vtable_t& a, const subobject_vtable_t& b) { return a.offset < b.offset; });
+            groups.push_back({set.primary, 0, first, uint32(subobjects.size()) - first, GROUP_MSVC});
+        }
+        std::sort(groups.begin(), groups.end(),
+                  [](const vtable_group_t& a, const vtable_group_t& b) { return a.start < b.start; });
+        index_headers();
+
+        for (const auto& g : groups)
+            if (g.kind == GROUP_MSVC) count_msvc(g, sorted_vtables, targets);
+
+        thunk_resolver::g_thunks.clear();
+        thunk_resolver::g_thunks.build(std::move(targets));
+        valid = true;
+    }
+
+    // Slot counts of an MSVC group's vftables, each bounded by the next vtable
+    // or secondary header; secondary slot targets go to `targets`
+    void count_msvc(const vtable_group_t& g, const std::vector<ea_t>& sorted_vtables, std::vector<ea_t>& targets) {
+        const int ps = get_ptr_size();
+        for (uint32 k = 0; k < g.count; ++k) {
+            subobject_vtable_t& sub = subobjects[g.first + k];
+            ea_t limit = sub.address + ea_t(vtable_utils::MAX_VTABLE_ENTRIES) * ps;
+            auto nv = std::upper_bound(sorted_vtables.begin(), sorted_vtables.end(), sub.address);
+            if (nv != sorted_vtables.end()) limit = std::min(limit, *nv);
+            limit = std::min(limit, next_header(sub.address));
+            std::vector<ea_t> primary_targets;
+            sub.slot_count = count_slots(sub.address, int((limit - sub.address) / ps),
+                                         k ? targets : primary_targets);
+        }
+    }
+
+    void index_headers() {
+        headers.clear();
+        for (const auto& g : groups)
+            for (uint32 k = 1; k < g.count; ++k) headers.push_back(subobjects[g.first + k].header);
+        std::sort(headers.begin(), headers.end());
+    }
+
+    const vtable_group_t* find(ea_t start) const {
+        auto it = std::lower_bound(groups.begin(), groups.end(), start,
+                                   [](const vtable_group_t& g, ea_t ea) { return g.start < ea; });
+        return (it != groups.end() && it->start == start) ? &*it : nullptr;
+    }
+
+    // Re-splits one Itanium group after its bytes changed, or recounts the
+    // slots of an MSVC one. Old Itanium subobjects are left unreferenced, as
+    // in the slot cache, until compact() reclaims them.
+    void redecode(ea_t start, const std::vector<ea_t>& sorted_vtables) {
+        auto it = std::lower_bound(groups.begin(), groups.end(), start,
+                                   [](const vtable_group_t& g, ea_t ea) { return g.start < ea; });
+        if (it == groups.end() || it->start != start) return;
+        if (it->kind == GROUP_MSVC) {
+            std::vector<ea_t> targets;
+            count_msvc(*it, sorted_vtables, targets);
+            return;
+        }
+        vtable_group_t g;
+        std::vector<ea_t> targets;
+        dead_subobjects += it->count;
+        if (decode(start, it->max_words, it->kind, g, targets)) *it = g;
+        else groups.erase(it);
+        if (dead_subobjects > subobjects.size() / 2) compact();
+        index_headers();
+    }
+
+    void compact() {
+        std::vector<subobject_vtable_t> live;
+        live.reserve(subobjects.size() - dead_subobjects);
+        for (auto& g : groups) {
+            const uint32 first = uint32(live.size());
+            live.insert(live.end(), subobjects.begin() + g.first, subobjects.begin() + g.first + g.count);
+            g.first = first;
+        }
+        subobjects.swap(live);
+        dead_subobjects = 0;
+    }
+
+    // First secondary vtable header after ea, BADADDR if none
+    ea_t next_header(ea_t ea) const {
+        auto it = std::upper_bound(headers.begin(), headers.end(), ea);
+        return it != headers.end() ? *it : BADADDR;
+    }
+
+    // Vtable of the subobject at `offset` in the group starting at start, BADADDR if none
+    ea_t subobject_at(ea_t start, int64 offset) const {
+        const vtable_group_t* g = find(start);
+        for (uint32 k = 0; g && k < g->count; ++k)
+            if (subobjects[g->first + k].offset == offset) return subobjects[g->first + k].address;
+        return BADADDR;
+    }
+
+    size_t secondary_count() const { return headers.size(); }
+
+    size_t construction_count() const {
+        size_t n = 0;
+        for (const auto& g : groups) n += g.kind == GROUP_CONSTRUCTION;
+        return n;
+    }
+
+    void clear() {
+        groups.clear();
+        subobjects.clear();
+        headers.clear();
+        dead_subobjects = 0;
+        valid = false;
+    }
+
+    size_t memory_usage() const {
+        return groups.capacity() * sizeof(vtable_group_t) + subobjects.capacity() * sizeof(subobject_vtable_t) +
+               headers.capacity() * sizeof(ea_t);
+    }
+};
+
+static group_table_t g_groups;
+
 struct VTableStats {
     int func_count = 0;
     int pure_virtual_count = 0;
 };
 
+constexpr int NO_STATUS = -1;
+
+// Slot comment as annotate_vtable() writes it. Statuses are OverrideStatus
+// values; with_statuses suppresses the [PURE] fallback, matching a status map
+// that simply has no entry for the slot. Kernel-free, so usable from workers.
+inline void format_slot_comment(char* buf, size_t size, int status, bool with_statuses, bool pure_virt,
+                                int vfunc_index, int ptr_size) {
+    const char* prefix = "";
+
+    // Determine prefix based on status (fixed width: 13 chars including space)
+    if (with_statuses) {
+        switch (status) {
+            case 0: prefix = "[Inherited]  "; break;  // INHERITED (11 + 2 spaces)
+            case 1: prefix = "[Override]   "; break;  // OVERRIDDEN (10 + 3 spaces)
+            case 2: prefix = "[NEW]        "; break;  // NEW_VIRTUAL (5 + 8 spaces)
+            case 3: prefix = "[Pure→Impl]  "; break;  // PURE_TO_IMPL (11 + 2 spaces)
+            case 4: prefix = "[Impl→Pure]  "; break;  // IMPL_TO_PURE (11 + 2 spaces)
+        }
+    } else if (pure_virt) {
+        prefix = "[PURE]       ";  // 6 + 7 spaces
+    }
+
+    snprintf(buf, size, "%sindex: %-3d | offset: %-4d", prefix, vfunc_index, vfunc_index * ptr_size);
+}
+
+// Header comment placed on the vtable address; base_name nullptr for roots
+inline void format_vtable_comment(char* buf, size_t size, const char* class_name, const char* base_name) {
+    if (base_name)
+        snprintf(buf, size, "vtable for '%s' : inherits '%s'", class_name, base_name);
+    else
+        snprintf(buf, size, "vtable for '%s' : (root class)", class_name);
+}
+
+// Slot flags kept by the slot cache
+enum slot_flags_t : uint8 {
+    SLOT_VALID = 1,
+    SLOT_PURE  = 2,
+};
+
+// Every slot one scan examined. Slot k sits at vtable + (start_offset + k) * ptr_size.
+struct slot_run_t {
+    int start_offset = 0;
+    std::vector<ea_t> ptrs;
+    std::vector<uint8> flags;
+};
+
+// Latest end of each vtable's slot run, precomputed for the sorted vtable list
+// with one cursor per input: the next vtable, the next secondary vtable
+// header, the end of the vtable's segment and the next named data item.
+// Scans then pay nothing per slot for boundary checks.
+struct scan_limits_t {
+    std::vector<ea_t> addrs;   // sorted vtables
+    std::vector<ea_t> fixed;   // segment end / next named data item, by position
+    std::vector<ea_t> limits;  // by position
+    bool valid = false;
+
+    void build(const std::vector<ea_t>& sorted_vtables, const vtable_utils::name_snapshot_t& names) {
+        using namespace vtable_utils;
+        addrs = sorted_vtables;
+        fixed.assign(addrs.size(), BADADDR);
+
+        std::vector<ea_t> named(names.eas);
+        if (!std::is_sorted(named.begin(), named.end())) std::sort(named.begin(), named.end());
+
+        // Code names are skipped once, as the cursor passes them, so the
+        // whole pass is O(V + N)
+        const ea_t reach = ea_t(MAX_VTABLE_ENTRIES) * get_ptr_size();
+        size_t n = 0;
+        for (size_t i = 0; i < addrs.size(); ++i) {
+            const ea_t vt = addrs[i];
+            ea_t limit = std::min(segment_end(vt), vt + reach);
+            while (n < named.size() && (named[n] <= vt || is_code(get_flags(named[n])))) ++n;
+            if (n < named.size()) limit = std::min(limit, named[n]);
+            fixed[i] = limit;
+        }
+        update();
+    }
+
+    // Folds in the vtable and secondary header bounds, which move with the groups
+    void update() {
+        const auto& headers = g_groups.headers;
+        limits.resize(addrs.size());
+        size_t h = 0, next = 0;
+        for (size_t i = 0; i < addrs.size(); ++i) {
+            ea_t limit = fixed[i];
+            // Next strictly greater address: duplicates must not lift the bound
+            while (next < addrs.size() && addrs[next] <= addrs[i]) ++next;
+            if (next < addrs.size()) limit = std::min(limit, addrs[next]);
+            while (h < headers.size() && headers[h] <= addrs[i]) ++h;
+            if (h < headers.size()) limit = std::min(limit, headers[h]);
+            limits[i] = limit;
+        }
+        valid = true;
+    }
+
+    // BADADDR when vt is not one of the listed vtables
+    ea_t limit_of(ea_t vt) const {
+        if (!valid) return BADADDR;
+        auto it = std::lower_bound(addrs.begin(), addrs.end(), vt);
+        return (it != addrs.end() && *it == vt) ? limits[it - addrs.begin()] : BADADDR;
+    }
+
+    void clear() {
+        addrs.clear();
+        fixed.clear();
+        limits.clear();
+        valid = false;
+    }
+
+    size_t memory_usage() const {
+        return (addrs.capacity() + fixed.capacity() + limits.capacity()) * sizeof(ea_t);
+    }
+};
+
+static scan_limits_t g_scan_limits;
+
+// Latest end of the slot run at vtable_addr (BADADDR: unbounded): the
+// precomputed limit for a listed vtable, else the next vtable or secondary header
+inline ea_t slot_limit(ea_t vtable_addr, const std::vector<ea_t>& sorted_vtables) {
+    const ea_t known = g_scan_limits.limit_of(vtable_addr);
+    if (known != BADADDR) return known;
+    return std::min(find_next_vtable(vtable_addr, sorted_vtables), g_groups.next_header(vtable_addr));
+}
+
+// Scans the slots of one vtable, reading no further than `limit`
 template<bool collect_entries, bool annotate>
-inline VTableStats scan_vtable(
+inline VTableStats scan_vtable_until(
     ea_t vtable_addr,
     bool is_windows,
-    const std::vector<ea_t>& sorted_vtables,
+    ea_t limit,
     std::vector<VTableEntry>* out_entries = nullptr,
-    const std::map<int, int>* status_map = nullptr)
+    const std::map<int, int>* status_map = nullptr,
+    slot_run_t* out_slots = nullptr)
 {
     using namespace vtable_utils;
 
     VTableStats stats;
     const int ptr_size = get_ptr_size();
     const int start_offset = detect_vfunc_start_offset(vtable_addr, is_windows);
-    const ea_t next_vtable = find_next_vtable(vtable_addr, sorted_vtables);
 
     int max_check = MAX_VTABLE_ENTRIES;
-    if (next_vtable != BADADDR && next_vtable > vtable_addr)
-        max_check = std::min(max_check, (int)((next_vtable - vtable_addr) / ptr_size));
+    if (limit != BADADDR && limit > vtable_addr)
+        max_check = (int)std::min<ea_t>(max_check, (limit - vtable_addr) / ptr_size);
 
     int consecutive_invalid = 0;
     int vfunc_index = 0;
     char cmt_buf[COMMENT_BUFFER_SIZE];
 
-    for (int i = start_offset; i < max_check && consecutive_invalid < CONSECUTIVE_INVALID_THRESHOLD; ++i) {
-        ea_t entry_addr = vtable_addr + (i * ptr_size);
-        if (!is_mapped(entry_addr)) break;
+    slot_block_t block;
+    decode_slots(vtable_addr + start_offset * ptr_size, max_check - start_offset, block);
+    const int slot_count = (int)block.ptrs.size();
 
-        if (std::binary_search(sorted_vtables.begin(), sorted_vtables.end(), entry_addr) &&
-            entry_addr != vtable_addr) break;
+    if (out_slots) {
+        out_slots->start_offset = start_offset;
+        out_slots->ptrs.clear();
+        out_slots->flags.clear();
+    }
 
-        ea_t func_ptr = read_ptr(entry_addr);
+    for (int k = 0; k < slot_count && consecutive_invalid < CONSECUTIVE_INVALID_THRESHOLD; ++k) {
+        const int i = start_offset + k;
+        ea_t entry_addr = vtable_addr + (i * ptr_size);
+
+        ea_t func_ptr = block.ptrs[k];
+        if (out_slots) {
+            out_slots->ptrs.push_back(func_ptr);
+            out_slots->flags.push_back(0);
+        }
         if (!func_ptr || func_ptr == BADADDR) {
             ++consecutive_invalid;
             continue;
         }
 
-        bool pure_virt = is_pure_virtual(func_ptr);
+        // Names are only consulted for pointers that survived the range check:
+        // executable targets, or mapped data that may be an imported pure-virtual stub
+        bool pure_virt = false;
+        bool valid = false;
+        if (block.exec[k]) {
+            pure_virt = is_pure_virtual(func_ptr);
+            valid = pure_virt || is_valid_exec_target(func_ptr);
+        } else if (is_addr_mapped(func_ptr)) {
+            pure_virt = is_pure_virtual(func_ptr);
+            valid = pure_virt;
+        }
 
-        if (!pure_virt && !is_valid_func_ptr(func_ptr)) {
-            if (is_typeinfo(func_ptr)) {
-                ++consecutive_invalid;
-                continue;
-            }
+        if (!valid) {
             ++consecutive_invalid;
             continue;
         }
@@ -140,6 +703,7 @@ inline VTableStats scan_vtable(
         consecutive_invalid = 0;
         stats.func_count++;
         if (pure_virt) stats.pure_virtual_count++;
+        if (out_slots) out_slots->flags.back() = uint8(SLOT_VALID | (pure_virt ? SLOT_PURE : 0));
 
         if constexpr (collect_entries) {
             if (out_entries) {
@@ -151,26 +715,13 @@ inline VTableStats scan_vtable(
             if (!is_code(get_flags(func_ptr)))
                 add_func(func_ptr);
 
-            int byte_offset = vfunc_index * ptr_size;
-            const char* prefix = "";
-
-            // Determine prefix based on status (fixed width: 13 chars including space)
+            int status = NO_STATUS;
             if (status_map) {
                 auto it = status_map->find(vfunc_index);
-                if (it != status_map->end()) {
-                    switch (it->second) {
-                        case 0: prefix = "[Inherited]  "; break;  // INHERITED (11 + 2 spaces)
-                        case 1: prefix = "[Override]   "; break;  // OVERRIDDEN (10 + 3 spaces)
-                        case 2: prefix = "[NEW]        "; break;  // NEW_VIRTUAL (5 + 8 spaces)
-                        case 3: prefix = "[Pure→Impl]  "; break;  // PURE_TO_IMPL (11 + 2 spaces)
-                        case 4: prefix = "[Impl→Pure]  "; break;  // IMPL_TO_PURE (11 + 2 spaces)
-                    }
-                }
-            } else if (pure_virt) {
-                prefix = "[PURE]       ";  // 6 + 7 spaces
+                if (it != status_map->end()) status = it->second;
             }
-
-            qsnprintf(cmt_buf, sizeof(cmt_buf), "%sindex: %-3d | offset: %-4d", prefix, vfunc_index, byte_offset);
+            format_slot_comment(cmt_buf, sizeof(cmt_buf), status, status_map != nullptr, pure_virt,
+                                vfunc_index, ptr_size);
             set_cmt(entry_addr, cmt_buf, false);
         }
 
@@ -180,8 +731,27 @@ inline VTableStats scan_vtable(
     return stats;
 }
 
-inline VTableStats get_vtable_stats(ea_t addr, bool is_win, const std::vector<ea_t>& vtables) {
-    return scan_vtable<false, false>(addr, is_win, vtables);
+template<bool collect_entries, bool annotate>
+inline VTableStats scan_vtable(
+    ea_t vtable_addr,
+    bool is_windows,
+    const std::vector<ea_t>& sorted_vtables,
+    std::vector<VTableEntry>* out_entries = nullptr,
+    const std::map<int, int>* status_map = nullptr,
+    slot_run_t* out_slots = nullptr)
+{
+    return scan_vtable_until<collect_entries, annotate>(vtable_addr, is_windows,
+                                                        slot_limit(vtable_addr, sorted_vtables),
+                                                        out_entries, status_map, out_slots);
+}
+
+inline VTableStats get_vtable_stats(ea_t addr, bool is_win, const std::vector<ea_t>& vtables,
+                                    slot_run_t* slots = nullptr) {
+    return scan_vtable<false, false>(addr, is_win, vtables, nullptr, nullptr, slots);
+}
+
+inline VTableStats get_vtable_stats_until(ea_t addr, bool is_win, ea_t limit, slot_run_t* slots = nullptr) {
+    return scan_vtable_until<false, false>(addr, is_win, limit, nullptr, nullptr, slots);
 }
 
 inline std::vector<VTableEntry> get_vtable_entries(ea_t addr, bool is_win, const std::vector<ea_t>& vtables) {
@@ -193,6 +763,84 @@ inline std::vector<VTableEntry> get_vtable_entries(ea_t addr, bool is_win, const
     return entries;
 }
 
+// Decoded slots of every vtable of one refresh, as a struct of arrays.
+// Runs are keyed by the vtable's position in the sorted address list; a
+// rescanned vtable appends a fresh run and the old one is left unreferenced
+// until enough garbage builds up to compact.
+struct slot_cache_t {
+    static constexpr uint32 NO_RUN = UINT32_MAX;
+
+    std::vector<uint32> first;   // ordinal -> first slot in ptrs/flags, NO_RUN if not decoded
+    std::vector<uint32> count;   // ordinal -> slots in the run
+    std::vector<uint8> start;    // ordinal -> start_offset of the run
+    std::vector<ea_t> ptrs;
+    std::vector<uint8> flags;    // slot_flags_t
+    size_t dead_slots = 0;
+
+    void reset(size_t vtable_count) {
+        first.assign(vtable_count, NO_RUN);
+        count.assign(vtable_count, 0);
+        start.assign(vtable_count, 0);
+        ptrs.clear();
+        flags.clear();
+        dead_slots = 0;
+    }
+
+    bool has(size_t ordinal) const { return ordinal < first.size() && first[ordinal] != NO_RUN; }
+
+    void store(size_t ordinal, const slot_run_t& run) {
+        if (ordinal >= first.size()) return;
+        if (first[ordinal] != NO_RUN) dead_slots += count[ordinal];
+        first[ordinal] = uint32(ptrs.size());
+        count[ordinal] = uint32(run.ptrs.size());
+        start[ordinal] = uint8(run.start_offset);
+        ptrs.insert(ptrs.end(), run.ptrs.begin(), run.ptrs.end());
+        flags.insert(flags.end(), run.flags.begin(), run.flags.end());
+        if (dead_slots > ptrs.size() / 2) compact();
+    }
+
+    // Valid slots as get_vtable_entries() would return them
+    std::vector<VTableEntry> entries(size_t ordinal, ea_t vtable_addr) const {
+        std::vector<VTableEntry> out;
+        if (!has(ordinal)) return out;
+
+        const int ptr_size = get_ptr_size();
+        const uint32 base = first[ordinal];
+        int vfunc_index = 0;
+        out.reserve(vtable_utils::ENTRY_RESERVE_SIZE);
+        for (uint32 k = 0; k < count[ordinal]; ++k) {
+            const uint8 f = flags[base + k];
+            if (!(f & SLOT_VALID)) continue;
+            out.push_back({vtable_addr + ea_t(start[ordinal] + k) * ptr_size, ptrs[base + k],
+                           vfunc_index++, (f & SLOT_PURE) != 0});
+        }
+        return out;
+    }
+
+    size_t memory_usage() const {
+        return first.capacity() * sizeof(uint32) + count.capacity() * sizeof(uint32) + start.capacity() +
+               ptrs.capacity() * sizeof(ea_t) + flags.capacity();
+    }
+
+private:
+    void compact() {
+        std::vector<ea_t> live_ptrs;
+        std::vector<uint8> live_flags;
+        live_ptrs.reserve(ptrs.size() - dead_slots);
+        live_flags.reserve(ptrs.size() - dead_slots);
+        for (size_t o = 0; o < first.size(); ++o) {
+            if (first[o] == NO_RUN) continue;
+            const uint32 at = uint32(live_ptrs.size());
+            live_ptrs.insert(live_ptrs.end(), ptrs.begin() + first[o], ptrs.begin() + first[o] + count[o]);
+            live_flags.insert(live_flags.end(), flags.begin() + first[o], flags.begin() + first[o] + count[o]);
+            first[o] = at;
+        }
+        ptrs.swap(live_ptrs);
+        flags.swap(live_flags);
+        dead_slots = 0;
+    }
+};
+
 inline int annotate_vtable(ea_t addr, bool is_win, const std::vector<ea_t>& vtables, const std::map<int, int>* status_map = nullptr) {
     return scan_vtable<false, true>(addr, is_win, vtables, nullptr, status_map).func_count;
 }
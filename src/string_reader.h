@@ -0,0 +1,130 @@
+#pragma once
+#include <ida.hpp>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "vtable_utils.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define STRING_READER_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define STRING_READER_NEON 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// RTTI name strings (type descriptor names, _ZTS strings) read in bulk:
+// page-bounded windows instead of one byte per call, with the end of the
+// printable run found 16 bytes at a time. Results are memoized by address,
+// since base-class names are re-read for every class deriving from them.
+
+namespace string_reader {
+
+inline bool is_name_byte(uint8 c) { return c >= 0x20 && c < 0x7F; }
+
+inline unsigned first_set_bit(uint32 m) {
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward(&i, m);
+    return unsigned(i);
+#else
+    return unsigned(__builtin_ctz(m));
+#endif
+}
+
+// Length of the printable ASCII run at p: NUL, control bytes, DEL and
+// anything >= 0x80 end it
+inline size_t printable_prefix(const uint8* p, size_t n) {
+    size_t i = 0;
+#if defined(STRING_READER_SSE2)
+    // Signed compare: bytes >= 0x80 are negative, so "< 0x20" catches them too
+    const __m128i low = _mm_set1_epi8(0x20);
+    const __m128i del = _mm_set1_epi8(0x7F);
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const __m128i bad = _mm_or_si128(_mm_cmplt_epi8(v, low), _mm_cmpeq_epi8(v, del));
+        const uint32 mask = uint32(_mm_movemask_epi8(bad));
+        if (mask) return i + first_set_bit(mask);
+    }
+#elif defined(STRING_READER_NEON)
+    const int8x16_t low = vdupq_n_s8(0x20);
+    const int8x16_t del = vdupq_n_s8(0x7F);
+    for (; i + 16 <= n; i += 16) {
+        const int8x16_t v = vld1q_s8(reinterpret_cast<const int8_t*>(p + i));
+        const uint8x16_t bad = vorrq_u8(vcltq_s8(v, low), vceqq_s8(v, del));
+        if (vmaxvq_u8(bad)) break;  // the scalar loop pins it down within this block
+    }
+#endif
+    while (i < n && is_name_byte(p[i])) ++i;
+    return i;
+}
+
+// Printable run at ea, at most `max` bytes, read one page-bounded window at a time
+inline void read_printable(ea_t ea, size_t max, std::string& out) {
+    using vtable_utils::STRING_WINDOW_SIZE;
+    out.clear();
+    std::vector<uint8> scratch;
+    while (out.size() < max) {
+        const ea_t at = ea + out.size();
+        const size_t to_page_end = STRING_WINDOW_SIZE - size_t(at % STRING_WINDOW_SIZE);
+        const size_t want = std::min(max - out.size(), to_page_end);
+
+        size_t got = 0;
+        const uint8* p = vtable_utils::read_mapped_span(at, want, scratch, &got);
+        const size_t n = printable_prefix(p, got);
+        out.append(reinterpret_cast<const char*>(p), n);
+        if (n < want) break;  // terminator, bad byte or unmapped
+    }
+}
+
+// Address -> string read there (or any string derived from that address,
+// via put()). Main thread only; cleared with the RTTI cache and whenever the
+// database bytes may have changed.
+struct string_memo_t {
+    std::unordered_map<ea_t, uint64> spans;  // ea -> arena offset << 32 | length
+    std::vector<char> arena;
+    std::string scratch;
+
+    bool find(ea_t ea, std::string& out) const {
+        auto it = spans.find(ea);
+        if (it == spans.end()) return false;
+        const size_t len = size_t(it->second & 0xFFFFFFFF);
+        if (len) out.assign(arena.data() + (it->second >> 32), len);
+        else out.clear();
+        return true;
+    }
+
+    void put(ea_t ea, const std::string& s) {
+        spans[ea] = (uint64(arena.size()) << 32) | s.size();
+        arena.insert(arena.end(), s.begin(), s.end());
+    }
+
+    std::string get(ea_t ea) {
+        std::string out;
+        if (!find(ea, out)) {
+            read_printable(ea, size_t(vtable_utils::MAX_RTTI_STRING_LENGTH), scratch);
+            put(ea, scratch);
+            out = scratch;
+        }
+        return out;
+    }
+
+    void clear() {
+        spans.clear();
+        arena.clear();
+    }
+
+    size_t memory_usage() const {
+        return arena.capacity() + spans.size() * (sizeof(ea_t) + sizeof(uint64) + 2 * sizeof(void*));
+    }
+};
+
+static string_memo_t g_string_memo;
+
+inline std::string read_rtti_string(ea_t ea) { return g_string_memo.get(ea); }
+
+} // namespace string_reader
@@ -0,0 +1,113 @@
+#pragma once
+#include <ida.hpp>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include "vtable_utils.h"
+
+// Adjustor thunks: secondary vtables point at `this`-adjusting stubs
+// (MSVC "[thunk]:X::f`adjustor{8}'", Itanium _ZThn) and incremental-link jump
+// stubs instead of the functions themselves. Each slot target is decoded once
+// and remembered, so comparisons can look through them at no extra cost.
+
+namespace thunk_resolver {
+
+constexpr int MAX_THUNK_HOPS = 4;      // adjustor -> ILT jump -> function, with room to spare
+constexpr size_t THUNK_READ_SIZE = 16;
+
+// Bytes of a `this` adjustment at p (x86/x64 encodings), 0 if there is none:
+// add/sub rcx|rdi|ecx, imm8|imm32, or add [esp+4], imm (i386 Itanium)
+inline size_t adjustment_length(const uint8* p, size_t n, bool x64) {
+    size_t i = 0;
+    if (x64) {
+        if (n < 1 || p[0] != 0x48) return 0;
+        i = 1;
+    }
+    if (n < i + 3 || (p[i] != 0x83 && p[i] != 0x81)) return 0;
+    const size_t imm = p[i] == 0x83 ? 1 : 4;
+    const uint8 modrm = p[i + 1];
+
+    // Register form: mod 11, /0 add or /5 sub, this-register rcx/ecx (1) or rdi (7, SysV x64)
+    const uint8 op = modrm & 0xF8;
+    const uint8 reg = modrm & 7;
+    if ((op == 0xC0 || op == 0xE8) && (reg == 1 || (x64 && reg == 7)))
+        return n >= i + 2 + imm ? i + 2 + imm : 0;
+
+    // add dword [esp+4], imm
+    if (!x64 && modrm == 0x44 && n >= i + 4 + imm && p[i + 2] == 0x24 && p[i + 3] == 0x04)
+        return i + 4 + imm;
+    return 0;
+}
+
+// Target of a jmp rel32 / rel8 at ea (p holds its bytes), BADADDR if p is no jump
+inline ea_t jump_target(ea_t ea, const uint8* p, size_t n) {
+    if (n >= 5 && p[0] == 0xE9) {
+        int32 rel;
+        memcpy(&rel, p + 1, 4);
+        return ea + 5 + ea_t(int64(rel));
+    }
+    if (n >= 2 && p[0] == 0xEB) return ea + 2 + ea_t(int64(int8(p[1])));
+    return BADADDR;
+}
+
+// One hop: the function a thunk at ea forwards to, BADADDR if ea is no thunk
+inline ea_t decode_thunk(ea_t ea, std::vector<uint8>& scratch) {
+    size_t got = 0;
+    const uint8* p = vtable_utils::read_mapped_span(ea, THUNK_READ_SIZE, scratch, &got);
+    const size_t skip = adjustment_length(p, got, vtable_utils::get_ptr_size() == 8);
+    const ea_t target = jump_target(ea + skip, p + skip, got - skip);
+    return target != BADADDR && target != ea && vtable_utils::is_exec_addr(target) ? target : BADADDR;
+}
+
+// Slot target -> function behind its thunks. Main thread only; cleared on
+// every refresh and whenever bytes are patched.
+struct thunk_cache_t {
+    std::unordered_map<ea_t, ea_t> targets;  // every decoded address, thunk or not
+    std::vector<uint8> scratch;
+
+    ea_t follow(ea_t ea) {
+        ea_t at = ea;
+        for (int hop = 0; hop < MAX_THUNK_HOPS; ++hop) {
+            const ea_t next = decode_thunk(at, scratch);
+            if (next == BADADDR) break;
+            at = next;
+        }
+        return at;
+    }
+
+    // One decoding pass over a batch of slot targets, in address order
+    void build(std::vector<ea_t> ptrs) {
+        std::sort(ptrs.begin(), ptrs.end());
+        ptrs.erase(std::unique(ptrs.begin(), ptrs.end()), ptrs.end());
+        targets.reserve(targets.size() + ptrs.size());
+        for (ea_t p : ptrs)
+            if (p && p != BADADDR && vtable_utils::is_exec_addr(p)) targets.emplace(p, follow(p));
+    }
+
+    ea_t resolve(ea_t ea) {
+        if (!ea || ea == BADADDR) return ea;
+        auto it = targets.find(ea);
+        if (it != targets.end()) return it->second;
+        const ea_t t = vtable_utils::is_exec_addr(ea) ? follow(ea) : ea;
+        targets.emplace(ea, t);
+        return t;
+    }
+
+    bool same_function(ea_t a, ea_t b) { return a == b || resolve(a) == resolve(b); }
+
+    size_t thunk_count() const {
+        size_t n = 0;
+        for (const auto& [from, to] : targets) n += from != to;
+        return n;
+    }
+
+    void clear() { targets.clear(); }
+
+    size_t memory_usage() const {
+        return targets.size() * (2 * sizeof(ea_t) + 2 * sizeof(void*)) + scratch.capacity();
+    }
+};
+
+static thunk_cache_t g_thunks;
+
+} // namespace thunk_resolver
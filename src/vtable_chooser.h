@@ -1,140 +1,485 @@
 #pragma once
 #include <ida.hpp>
 #include <kernwin.hpp>
+#include <xref.hpp>
 #include <vector>
 #include <string>
 #include <map>
 #include <set>
+#include <unordered_map>
 #include "vtable_detector.h"
 #include "smart_annotator.h"
 #include "rtti_parser.h"
 #include "vtable_comparison.h"
 #include "inheritance_graph.h"
+#include "vtable_persist.h"
+#include "class_hierarchy.h"
+#include "override_analysis.h"
+#include "annotation_plan.h"
 #include "vtable_utils.h"
 
 struct vtable_cache_t {
     std::vector<VTableInfo> vtables;
     std::vector<ea_t> sorted_addrs;
+    class_hierarchy::hierarchy_t hierarchy;  // base <-> derived edges of the current scan
     bool valid = false;
 
+    // Positions in vtables, rebuilt whenever the vector is reordered
+    std::vector<uint32> index_by_class;             // class ID -> position
+    std::unordered_map<ea_t, uint32> index_by_addr;  // vtable EA -> position (first entry wins)
+
+    override_analysis::override_table_t overrides;  // built on first use after each relink
+    smart_annotator::slot_cache_t slots;             // decoded slots, by position in sorted_addrs
+
+    // Pending IDB changes, applied on the next ensure()
+    std::set<ea_t> dirty;             // vtables whose slots or RTTI need a rescan
+    bool needs_full_refresh = false;  // the set of vtables itself may have changed
+
     void refresh() {
-        vtables = vtable_detector::find_vtables();
+        memory_image::image_scope_t image;  // scanners read this snapshot, not the kernel
+        vtable_utils::name_snapshot_t names;
+        names.capture();
+        rebuild(names);
+        vtable_persist::save(vtables, sorted_addrs, vtable_persist::compute_fingerprint(names));
+    }
+
+    // Maps the scan stored in the IDB back in while its fingerprint still
+    // matches the database, otherwise falls back to a full refresh.
+    // A valid cache only gets the pending IDB changes applied.
+    void ensure() {
+        if (valid) {
+            if (needs_full_refresh) refresh();
+            else if (!dirty.empty()) apply_dirty();
+            return;
+        }
+
+        memory_image::image_scope_t image;
+        vtable_utils::name_snapshot_t names;
+        names.capture();
+        const vtable_persist::fingerprint_t fp = vtable_persist::compute_fingerprint(names);
+
+        if (vtable_persist::load(fp, vtables, sorted_addrs)) {
+            smart_annotator::g_symbol_index.build(names);
+            rtti_detector::g_config_registry.build(sorted_addrs);
+            build_groups(names);
+            smart_annotator::g_scan_limits.build(sorted_addrs, names);
+            slots.reset(sorted_addrs.size());  // decoded on first use
+            hierarchy.build(vtables, class_pool::g_class_pool.size());
+            build_index();
+            valid = true;
+            dirty.clear();
+            needs_full_refresh = false;
+            return;
+        }
+
+        rebuild(names);
+        vtable_persist::save(vtables, sorted_addrs, fp);
+    }
+
+    void rebuild(const vtable_utils::name_snapshot_t& names) {
+        smart_annotator::g_symbol_index.build(names);
+        rtti_parser::clear_rtti_cache();
+        class_pool::g_class_pool.clear();
+        vtables = vtable_detector::find_vtables(names);
         sorted_addrs.clear();
         sorted_addrs.reserve(vtables.size());
         for (const auto &v : vtables)
             sorted_addrs.push_back(v.address);
         std::sort(sorted_addrs.begin(), sorted_addrs.end());
+        sorted_addrs.erase(std::unique(sorted_addrs.begin(), sorted_addrs.end()), sorted_addrs.end());
 
-        std::map<std::string, ea_t> class_to_vtable;
-        for (const auto &vt : vtables) {
-            class_to_vtable[vt.class_name] = vt.address;
+        rtti_detector::g_config_registry.build(sorted_addrs);
+        rtti_parser::g_rtti_cache.fill(sorted_addrs);  // one sorted pass, no per-vtable inserts
+        build_groups(names);
+        smart_annotator::g_scan_limits.build(sorted_addrs, names);
+        slots.reset(sorted_addrs.size());
+        scan_all();
+        link_hierarchy();
+
+        valid = true;
+        dirty.clear();
+        needs_full_refresh = false;
+    }
+
+    // Splits every vtable group into its subobject vtables, ahead of the slot
+    // scans that stop at the first secondary one
+    void build_groups(const vtable_utils::name_snapshot_t& names) {
+        std::vector<ea_t> itanium;
+        std::vector<smart_annotator::vftable_set_t> msvc;
+        for (const auto& v : vtables) {
+            if (v.is_intermediate) continue;
+            if (!v.is_windows) itanium.push_back(v.address);
+            else if (!v.secondary_vftables.empty()) msvc.push_back({v.address, &v.secondary_vftables});
         }
+        std::sort(itanium.begin(), itanium.end());
+        smart_annotator::g_groups.build(names, itanium, msvc, sorted_addrs);
+    }
 
-        for (auto &vt : vtables) {
-            auto stats = smart_annotator::get_vtable_stats(vt.address, vt.is_windows, sorted_addrs);
-            vt.func_count = stats.func_count;
-            vt.pure_virtual_count = stats.pure_virtual_count;
-
-            const auto& inherit_info = rtti_parser::get_inheritance_info(vt.address);
-            vt.base_classes.clear();
-            for (const auto& base : inherit_info.base_classes) {
-                vt.base_classes.push_back(base.class_name);
-            }
-            vt.has_multiple_inheritance = inherit_info.has_multiple_inheritance;
-            vt.has_virtual_inheritance = inherit_info.has_virtual_inheritance;
+    // Derived class's vtable facing one of its bases: the subobject vtable at
+    // the base's offset, else the primary
+    ea_t vtable_facing(const VTableInfo& derived, class_pool::class_id_t base) const {
+        const auto* rec = rtti_parser::g_rtti_cache.find(derived.address);
+        if (!rec) return derived.address;
+        for (const auto& b : rtti_parser::g_rtti_cache.bases_of(*rec)) {
+            if (b.class_id != base || b.is_virtual || b.offset == 0) continue;
+            const ea_t sub = smart_annotator::g_groups.subobject_at(derived.address, b.offset);
+            if (sub != BADADDR) return sub;
+        }
+        return derived.address;
+    }
 
-            if (!vt.base_classes.empty()) {
-                vt.parent_class = vt.base_classes[0];
-            }
+    // Re-scans only the vtables touched since the last scan, then relinks the
+    // hierarchy from the (cached) per-vtable results. The IDB copy is left
+    // alone: its fingerprint no longer matches, so the next open rescans.
+    void apply_dirty() {
+        rtti_parser::clear_decode_caches();  // patched bytes may have changed names or hierarchies
+        thunk_resolver::g_thunks.clear();
+        for (auto &vt : vtables) {
+            if (vt.is_intermediate || dirty.find(vt.address) == dirty.end()) continue;
+            rtti_parser::forget_rtti(vt.address);
+            smart_annotator::g_groups.redecode(vt.address, sorted_addrs);
+        }
+        smart_annotator::g_scan_limits.update();  // secondary headers may have moved
+        for (auto &vt : vtables) {
+            if (vt.is_intermediate || dirty.find(vt.address) == dirty.end()) continue;
+            scan_one(vt, ordinal_of(vt.address));
+        }
+        dirty.clear();
+        link_hierarchy();
+    }
 
-            vt.derived_classes.clear();
-            vt.derived_count = 0;
+    // Every vtable in address order, walking sorted_addrs with one cursor so
+    // each scan takes its slot limit by position
+    void scan_all() {
+        std::vector<std::pair<ea_t, uint32>> order;
+        order.reserve(vtables.size());
+        for (size_t i = 0; i < vtables.size(); ++i)
+            order.emplace_back(vtables[i].address, uint32(i));
+        std::sort(order.begin(), order.end());
+
+        size_t ord = 0;
+        for (const auto& [addr, i] : order) {
+            while (ord < sorted_addrs.size() && sorted_addrs[ord] < addr) ++ord;
+            scan_one(vtables[i], ord < sorted_addrs.size() && sorted_addrs[ord] == addr ? ord : SIZE_MAX);
         }
+    }
 
-        std::map<std::string, std::vector<std::string>> base_to_derived;
-        for (const auto &vt : vtables) {
-            for (const auto& base : vt.base_classes) {
-                base_to_derived[base].push_back(vt.class_name);
-            }
+    void scan_one(VTableInfo& vt, size_t ord) {
+        const auto& limits = smart_annotator::g_scan_limits;
+        const ea_t limit = ord != SIZE_MAX && limits.valid && ord < limits.limits.size()
+                               ? limits.limits[ord]
+                               : smart_annotator::slot_limit(vt.address, sorted_addrs);
+        smart_annotator::slot_run_t run;
+        auto stats = smart_annotator::get_vtable_stats_until(vt.address, vt.is_windows, limit, &run);
+        if (ord != SIZE_MAX) slots.store(ord, run);
+        vt.func_count = stats.func_count;
+        vt.pure_virtual_count = stats.pure_virtual_count;
+
+        const auto& rtti = rtti_parser::get_inheritance_info(vt.address);
+        vt.base_ids.clear();
+        for (const auto& base : rtti_parser::g_rtti_cache.bases_of(rtti))
+            vt.base_ids.push_back(base.class_id);
+        vt.has_multiple_inheritance = rtti.has_multiple_inheritance();
+        vt.has_virtual_inheritance = rtti.has_virtual_inheritance();
+        vt.parent_id = vt.base_ids.empty() ? class_pool::NO_CLASS : vt.base_ids[0];
+    }
+
+    // Derived lists and intermediate classes only depend on the per-vtable
+    // scan results, so they are rebuilt wholesale without touching the IDB.
+    // Class IDs are dense, so the lookups are plain ID-indexed vectors.
+    void link_hierarchy() {
+        using class_pool::class_id_t;
+        using class_pool::NO_CLASS;
+        constexpr size_t NO_INDEX = SIZE_MAX;
+
+        vtables.erase(std::remove_if(vtables.begin(), vtables.end(),
+                                     [](const VTableInfo& v) { return v.is_intermediate; }),
+                      vtables.end());
+
+        const size_t class_count = class_pool::g_class_pool.size();
+        std::vector<size_t> class_to_index(class_count, NO_INDEX);
+        for (size_t i = 0; i < vtables.size(); ++i) {
+            class_to_index[vtables[i].class_id] = i;
+            vtables[i].derived_ids.clear();
+            vtables[i].derived_count = 0;
         }
 
+        // Intermediates have no base_ids, so the edges are complete before they are added
+        hierarchy.build(vtables, class_count);
+        auto derived_of = [&](class_id_t base) {
+            return std::vector<class_id_t>(hierarchy.children.begin(base), hierarchy.children.end(base));
+        };
+
         std::vector<VTableInfo> intermediate_classes;
-        std::set<std::string> seen_intermediate;
+        std::vector<bool> seen_intermediate(class_count, false);
 
         for (const auto &vt : vtables) {
-            for (size_t i = 0; i < vt.base_classes.size(); ++i) {
-                const std::string& base = vt.base_classes[i];
-                if (class_to_vtable.find(base) == class_to_vtable.end() &&
-                    seen_intermediate.find(base) == seen_intermediate.end()) {
-
-                    seen_intermediate.insert(base);
-
-                    ea_t parent_vtable = BADADDR;
-                    std::string parent_name;
-                    for (size_t j = i + 1; j < vt.base_classes.size(); ++j) {
-                        auto it = class_to_vtable.find(vt.base_classes[j]);
-                        if (it != class_to_vtable.end()) {
-                            parent_vtable = it->second;
-                            parent_name = vt.base_classes[j];
+            for (size_t i = 0; i < vt.base_ids.size(); ++i) {
+                const class_id_t base = vt.base_ids[i];
+                if (class_to_index[base] == NO_INDEX && !seen_intermediate[base]) {
+
+                    // Earlier intermediates can serve as parents too, just without a vtable
+                    const VTableInfo* parent = nullptr;
+                    class_id_t parent_id = NO_CLASS;
+                    for (size_t j = i + 1; j < vt.base_ids.size(); ++j) {
+                        const class_id_t candidate = vt.base_ids[j];
+                        if (class_to_index[candidate] != NO_INDEX) {
+                            parent = &vtables[class_to_index[candidate]];
+                            parent_id = candidate;
+                            break;
+                        }
+                        if (seen_intermediate[candidate]) {
+                            parent_id = candidate;
                             break;
                         }
                     }
+                    seen_intermediate[base] = true;
 
                     VTableInfo intermediate;
                     intermediate.address = BADADDR;
-                    intermediate.class_name = base;
-                    intermediate.display_name = parent_name.empty() ?
+                    intermediate.class_id = base;
+                    intermediate.display_id = parent_id == NO_CLASS ?
                         base :
-                        parent_name + "::" + base;
+                        class_pool::intern(std::string(class_pool::name_of(parent_id)) + "::" +
+                                           class_pool::name_of(base));
                     intermediate.is_windows = vt.is_windows;
-                    intermediate.func_count = 0;
-                    intermediate.pure_virtual_count = 0;
+                    intermediate.func_count = parent ? parent->func_count : 0;
+                    intermediate.pure_virtual_count = parent ? parent->pure_virtual_count : 0;
                     intermediate.derived_count = 0;
                     intermediate.has_multiple_inheritance = false;
                     intermediate.has_virtual_inheritance = false;
                     intermediate.is_intermediate = true;
-                    intermediate.parent_vtable_addr = parent_vtable;
-                    intermediate.parent_class = parent_name;
-
-                    if (parent_vtable != BADADDR) {
-                        auto stats = smart_annotator::get_vtable_stats(parent_vtable, vt.is_windows, sorted_addrs);
-                        intermediate.func_count = stats.func_count;
-                        intermediate.pure_virtual_count = stats.pure_virtual_count;
-                    }
+                    intermediate.confidence = vtable_utils::SYMBOL_CONFIDENCE;
+                    intermediate.parent_vtable_addr = parent ? parent->address : BADADDR;
+                    intermediate.parent_id = parent_id;
 
-                    auto derived_it = base_to_derived.find(base);
-                    if (derived_it != base_to_derived.end()) {
-                        intermediate.derived_classes = derived_it->second;
-                        intermediate.derived_count = static_cast<int>(derived_it->second.size());
-                    }
+                    intermediate.derived_ids = derived_of(base);
+                    intermediate.derived_count = static_cast<int>(intermediate.derived_ids.size());
 
                     intermediate_classes.push_back(std::move(intermediate));
-                    class_to_vtable[base] = BADADDR;
                 }
             }
         }
 
+        for (auto &vt : vtables) {
+            vt.derived_ids = derived_of(vt.class_id);
+            vt.derived_count = static_cast<int>(vt.derived_ids.size());
+        }
+
         for (auto& inter : intermediate_classes) {
             vtables.push_back(std::move(inter));
         }
 
-        for (auto &vt : vtables) {
-            if (!vt.is_intermediate) {
-                auto it = base_to_derived.find(vt.class_name);
-                if (it != base_to_derived.end()) {
-                    vt.derived_classes = it->second;
-                    vt.derived_count = static_cast<int>(it->second.size());
-                }
-            }
+        std::sort(vtables.begin(), vtables.end(),
+            [](const VTableInfo& a, const VTableInfo& b) { return class_pool::name_less(a.class_id, b.class_id); });
+        build_index();
+    }
+
+    void build_index() {
+        constexpr uint32 NO_INDEX = UINT32_MAX;
+        overrides.clear();  // keyed by position
+        index_by_class.assign(class_pool::g_class_pool.size(), NO_INDEX);
+        index_by_addr.clear();
+        index_by_addr.reserve(vtables.size());
+        for (uint32 i = 0; i < vtables.size(); ++i) {
+            const VTableInfo& vt = vtables[i];
+            if (index_by_class[vt.class_id] == NO_INDEX)
+                index_by_class[vt.class_id] = i;
+            if (vt.address != BADADDR)
+                index_by_addr.emplace(vt.address, i);
         }
+    }
 
-        std::sort(vtables.begin(), vtables.end(),
-            [](const VTableInfo& a, const VTableInfo& b) { return a.class_name < b.class_name; });
+    const VTableInfo* find_by_class(class_pool::class_id_t id) const {
+        if (id >= index_by_class.size() || index_by_class[id] >= vtables.size()) return nullptr;
+        return &vtables[index_by_class[id]];
+    }
 
-        valid = true;
+    const VTableInfo* find_by_class(const std::string& name) const {
+        return find_by_class(class_pool::find(name));
+    }
+
+    const VTableInfo* find_by_address(ea_t ea) const {
+        auto it = index_by_addr.find(ea);
+        return it != index_by_addr.end() ? &vtables[it->second] : nullptr;
+    }
+
+    // Position of a vtable in sorted_addrs, SIZE_MAX if it is not one of ours
+    size_t ordinal_of(ea_t addr) const {
+        auto it = std::lower_bound(sorted_addrs.begin(), sorted_addrs.end(), addr);
+        return (it != sorted_addrs.end() && *it == addr) ? size_t(it - sorted_addrs.begin()) : SIZE_MAX;
+    }
+
+    // Entries of a vtable from the slot cache; only addresses outside the
+    // scan (or not yet decoded after a load) go to the database
+    std::vector<smart_annotator::VTableEntry> entries_of(ea_t addr, bool is_windows) {
+        const size_t ord = ordinal_of(addr);
+        if (ord == SIZE_MAX)
+            return smart_annotator::get_vtable_entries(addr, is_windows, sorted_addrs);
+        if (!slots.has(ord)) {
+            smart_annotator::slot_run_t run;
+            smart_annotator::get_vtable_stats(addr, is_windows, sorted_addrs, &run);
+            slots.store(ord, run);
+        }
+        return slots.entries(ord, addr);
+    }
+
+    // Decodes every vtable the cache has no slots for yet (after a load)
+    void ensure_slots() {
+        for (const auto& vt : vtables) {
+            if (vt.is_intermediate) continue;
+            const size_t ord = ordinal_of(vt.address);
+            if (ord == SIZE_MAX || slots.has(ord)) continue;
+            smart_annotator::slot_run_t run;
+            smart_annotator::get_vtable_stats(vt.address, vt.is_windows, sorted_addrs, &run);
+            slots.store(ord, run);
+        }
+    }
+
+    const override_analysis::override_table_t& override_table() {
+        if (!overrides.valid) {
+            overrides.build(vtables, hierarchy,
+                            [&](class_pool::class_id_t id) -> size_t {
+                                return id < index_by_class.size() ? index_by_class[id] : SIZE_MAX;
+                            },
+                            [&](size_t pos, class_pool::class_id_t base) { return vtable_facing(vtables[pos], base); },
+                            [&](ea_t addr, bool is_windows) { return entries_of(addr, is_windows); });
+        }
+        return overrides;
+    }
+
+    vtable_comparison::VTableComparison compare(ea_t derived_vt, ea_t base_vt, bool is_windows,
+                                                const std::string& derived_cls = "",
+                                                const std::string& base_cls = "") {
+        return vtable_comparison::compare_entries(entries_of(derived_vt, is_windows),
+                                                  entries_of(base_vt, is_windows),
+                                                  derived_vt, base_vt, derived_cls, base_cls);
+    }
+
+    // Vtable address of a class (BADADDR for unknown or intermediate classes)
+    ea_t vtable_of(class_pool::class_id_t id) const {
+        const VTableInfo* vt = find_by_class(id);
+        return vt ? vt->address : BADADDR;
+    }
+
+    // Heap held by the cached scan. string_equivalent_bytes is what the same
+    // class references cost as individual std::string copies (the pre-pool layout).
+    struct memory_report_t {
+        size_t vtable_count = 0;
+        size_t class_count = 0;
+        size_t class_refs = 0;
+        size_t pool_bytes = 0;
+        size_t vtable_bytes = 0;
+        size_t slot_cache_bytes = 0;
+        size_t rtti_cache_bytes = 0;
+        size_t rtti_records = 0;
+        size_t group_bytes = 0;
+        size_t secondary_vtables = 0;
+        size_t construction_vtables = 0;
+        size_t resolved_thunks = 0;
+        size_t string_equivalent_bytes = 0;
+    };
+
+    memory_report_t memory_report() const {
+        memory_report_t r;
+        r.vtable_count = vtables.size();
+        r.class_count = class_pool::g_class_pool.size();
+        r.pool_bytes = class_pool::g_class_pool.memory_usage();
+        r.vtable_bytes = vtables.capacity() * sizeof(VTableInfo) + sorted_addrs.capacity() * sizeof(ea_t) +
+                         hierarchy.memory_usage();
+        r.slot_cache_bytes = slots.memory_usage();
+        r.rtti_cache_bytes = rtti_parser::g_rtti_cache.memory_usage() + rtti_parser::decode_cache_bytes();
+        r.rtti_records = rtti_parser::g_rtti_cache.records.size();
+        r.group_bytes = smart_annotator::g_groups.memory_usage() + thunk_resolver::g_thunks.memory_usage() +
+                        smart_annotator::g_scan_limits.memory_usage();
+        r.secondary_vtables = smart_annotator::g_groups.secondary_count();
+        r.construction_vtables = smart_annotator::g_groups.construction_count();
+        r.resolved_thunks = thunk_resolver::g_thunks.thunk_count();
+
+        auto as_string = [&](class_pool::class_id_t id) {
+            ++r.class_refs;
+            const size_t len = class_pool::g_class_pool.length(id);
+            const size_t sso = 15;  // typical small-string capacity
+            r.string_equivalent_bytes += sizeof(std::string) + (len > sso ? len + 1 : 0);
+        };
+
+        for (const auto& vt : vtables) {
+            r.vtable_bytes += (vt.base_ids.capacity() + vt.derived_ids.capacity()) * sizeof(class_pool::class_id_t) +
+                              vt.secondary_vftables.capacity() * sizeof(ea_t);
+            as_string(vt.class_id);
+            as_string(vt.display_id);
+            if (vt.parent_id != class_pool::NO_CLASS) as_string(vt.parent_id);
+            for (auto id : vt.base_ids) as_string(id);
+            for (auto id : vt.derived_ids) as_string(id);
+        }
+        for (const auto& b : rtti_parser::g_rtti_cache.bases) as_string(b.class_id);
+        return r;
     }
 
     void invalidate() { valid = false; }
+
+    // Forgets everything tied to the open database (plugin unload)
+    void reset() {
+        vtables.clear();
+        sorted_addrs.clear();
+        hierarchy.clear();
+        overrides.clear();
+        slots.reset(0);
+        index_by_class.clear();
+        index_by_addr.clear();
+        dirty.clear();
+        needs_full_refresh = false;
+        valid = false;
+    }
+
+    // IDB change notifications (hooked in main.cpp)
+
+    void on_renamed(ea_t ea, const char* new_name, const char* old_name) {
+        const bool reclassified = smart_annotator::g_symbol_index.on_rename(ea, new_name);
+        if (!valid) return;
+
+        if (vtable_detector::is_structural_symbol(new_name) ||
+            vtable_detector::is_structural_symbol(old_name)) {
+            needs_full_refresh = true;
+            return;
+        }
+        if (reclassified) mark_referrers(ea);
+    }
+
+    void on_bytes_patched(ea_t ea) {
+        if (valid) mark_containing(ea);
+    }
+
+    // A new function turns a slot target into code, which can extend a vtable
+    void on_func_added(ea_t start_ea) {
+        if (valid) mark_referrers(start_ea);
+    }
+
+    void on_segments_changed() {
+        if (valid) needs_full_refresh = true;
+    }
+
+    // Vtables whose slots point at target, found through IDA's data xrefs
+    void mark_referrers(ea_t target) {
+        xrefblk_t xb;
+        for (bool ok = xb.first_to(target, XREF_DATA); ok; ok = xb.next_to())
+            mark_containing(xb.from);
+    }
+
+    // The vtable whose slot region holds ea, and the next one if ea sits in its header
+    void mark_containing(ea_t ea) {
+        if (sorted_addrs.empty()) return;
+        const ea_t ps = vtable_utils::get_ptr_size();
+
+        auto it = std::upper_bound(sorted_addrs.begin(), sorted_addrs.end(), ea);
+        if (it != sorted_addrs.begin()) {
+            ea_t vt = *(it - 1);
+            if (ea < vt + (vtable_utils::MAX_VTABLE_ENTRIES + vtable_utils::MAX_VFUNC_SEARCH_DEPTH) * ps)
+                dirty.insert(vt);
+        }
+        if (it != sorted_addrs.end() && *it - ea <= vtable_utils::MAX_VFUNC_SEARCH_DEPTH * ps)
+            dirty.insert(*it);
+    }
 };
 
 static vtable_cache_t g_vtable_cache;
@@ -160,19 +505,13 @@ public:
 
     func_browser_t(const std::string& cls_name, ea_t vt_addr,
                    const std::vector<smart_annotator::VTableEntry>& ents,
-                   const vtable_comparison::VTableComparison* comp = nullptr)
+                   std::map<int, vtable_comparison::OverrideStatus> statuses = {})
         : chooser_t(flags_, qnumber(widths_), widths_, header_, "Functions"),
-          entries(ents), vtable_addr(vt_addr)
+          entries(ents), vtable_addr(vt_addr), status_map(std::move(statuses))
     {
         title_storage.sprnt("Functions: %s", cls_name.c_str());
         title = title_storage.c_str();
         popup_names[POPUP_INS] = "Jump to Function";
-
-        if (comp) {
-            for (const auto& entry : comp->entries) {
-                status_map[entry.index] = entry.status;
-            }
-        }
     }
 
     virtual size_t idaapi get_count() const override {
@@ -402,7 +741,7 @@ public:
 
         if (!g_vtable_cache.valid) {
             try {
-                g_vtable_cache.refresh();
+                g_vtable_cache.ensure();
             } catch (...) {
                 g_vtable_cache.vtables.clear();
             }
@@ -420,12 +759,12 @@ public:
 
         const VTableInfo &vt = g_vtable_cache.vtables[n];
 
-        cols->at(0) = vt.display_name.c_str();
+        cols->at(0) = vt.display_name();
 
-        if (!vt.base_classes.empty()) {
-            cols->at(1) = vt.base_classes[0].c_str();
-        } else if (!vt.parent_class.empty()) {
-            cols->at(1) = vt.parent_class.c_str();
+        if (!vt.base_ids.empty()) {
+            cols->at(1) = class_pool::name_of(vt.base_ids[0]);
+        } else if (vt.parent_id != class_pool::NO_CLASS) {
+            cols->at(1) = vt.parent_class();
         } else {
             cols->at(1) = "";
         }
@@ -461,7 +800,7 @@ public:
             status = "Intermediate";
         } else if (vt.pure_virtual_count > 0) {
             status = "Abstract";
-        } else if (!vt.base_classes.empty()) {
+        } else if (!vt.base_ids.empty()) {
             status = "Has Base";
         } else {
             status = "Root";
@@ -472,7 +811,7 @@ public:
             if (attrs) attrs->color = 0xA0A0A0;
         } else if (vt.pure_virtual_count > 0) {
             if (attrs) attrs->color = vtable_utils::CLASS_MULTIPLE_INHERIT;
-        } else if (vt.base_classes.empty() && !vt.is_intermediate) {
+        } else if (vt.base_ids.empty() && !vt.is_intermediate) {
             if (attrs) attrs->color = vtable_utils::CLASS_VIRTUAL_INHERIT;
         }
     }
@@ -489,42 +828,30 @@ public:
                 info("Intermediate Class\n\n"
                      "Class: %s\nNo vtable symbol (inlined by compiler)\n"
                      "Jumped to parent: %s @ 0x%llX",
-                     vt.class_name.c_str(), vt.parent_class.c_str(),
+                     vt.class_name(), vt.parent_class(),
                      (unsigned long long)vt.parent_vtable_addr);
             } else {
                 info("Intermediate Class\n\n"
                      "Class: %s\nNo vtable symbol (inlined by compiler)\n"
                      "No parent vtable found",
-                     vt.class_name.c_str());
+                     vt.class_name());
             }
             return cbret_t(n);
         }
 
         // Get base class for comparison (same logic as annotate_all_vtables)
         std::map<int, int> status_map;
-        std::string base_for_comp = !vt.base_classes.empty() ? vt.base_classes[0] : "";
-        if (!base_for_comp.empty()) {
-            ea_t base_vtable = vtable_comparison::find_vtable_by_class_name(base_for_comp, g_vtable_cache.vtables);
-            if (base_vtable != BADADDR) {
-                auto comp = vtable_comparison::compare_vtables(
-                    vt.address, base_vtable, vt.is_windows,
-                    g_vtable_cache.sorted_addrs, vt.class_name, base_for_comp);
-
-                for (const auto& entry : comp.entries) {
-                    status_map[entry.index] = static_cast<int>(entry.status);
-                }
-            }
+        class_pool::class_id_t base_for_comp = !vt.base_ids.empty() ? vt.base_ids[0] : class_pool::NO_CLASS;
+        if (base_for_comp != class_pool::NO_CLASS) {
+            const auto& overrides = g_vtable_cache.override_table();
+            if (const auto* edge = overrides.find(vt.class_id, base_for_comp, vt.address))
+                overrides.fill_status_map(*edge, status_map);
         }
 
         // Add vtable header comment with parent class info
         char vtable_cmt[256];
-        if (!base_for_comp.empty()) {
-            qsnprintf(vtable_cmt, sizeof(vtable_cmt), "vtable for '%s' : inherits '%s'",
-                     vt.class_name.c_str(), base_for_comp.c_str());
-        } else {
-            qsnprintf(vtable_cmt, sizeof(vtable_cmt), "vtable for '%s' : (root class)",
-                     vt.class_name.c_str());
-        }
+        smart_annotator::format_vtable_comment(vtable_cmt, sizeof(vtable_cmt), vt.class_name(),
+            base_for_comp != class_pool::NO_CLASS ? class_pool::name_of(base_for_comp) : nullptr);
         set_cmt(vt.address, vtable_cmt, false);
 
         int count = smart_annotator::annotate_vtable(vt.address, vt.is_windows, g_vtable_cache.sorted_addrs,
@@ -533,7 +860,7 @@ public:
 
         info("VTable Annotation Complete\n\n"
              "Class: %s\nAddress: 0x%llX\nFunctions annotated: %d%s",
-             vt.class_name.c_str(), (unsigned long long)vt.address, count,
+             vt.class_name(), (unsigned long long)vt.address, count,
              vt.pure_virtual_count > 0 ? "\n(Abstract class)" : "");
 
         return cbret_t(n);
@@ -561,7 +888,8 @@ public:
         }
         const VTableInfo& vt = g_vtable_cache.vtables[n];
         inheritance_graph::show_inheritance_graph(
-            vt.class_name, vt.address, vt.is_windows, &g_vtable_cache.vtables
+            vt.class_id, vt.address, vt.is_windows, &g_vtable_cache.vtables, g_vtable_cache.hierarchy,
+            g_vtable_cache.override_table()
         );
     }
 
@@ -572,13 +900,14 @@ public:
         }
         const VTableInfo& vt = g_vtable_cache.vtables[last_selection];
         inheritance_graph::show_inheritance_graph(
-            vt.class_name, vt.address, vt.is_windows, &g_vtable_cache.vtables
+            vt.class_id, vt.address, vt.is_windows, &g_vtable_cache.vtables, g_vtable_cache.hierarchy,
+            g_vtable_cache.override_table()
         );
     }
 
 private:
-    bool select_base_class(const std::vector<std::string>& base_classes,
-                          std::string& selected_base) const {
+    bool select_base_class(const std::vector<class_pool::class_id_t>& base_classes,
+                          class_pool::class_id_t& selected_base) const {
         if (base_classes.size() == 1) {
             selected_base = base_classes[0];
             return true;
@@ -586,7 +915,7 @@ private:
 
         qstring selection_text = "Select base class:\n\n";
         for (size_t i = 0; i < base_classes.size(); ++i) {
-            selection_text.cat_sprnt("%d. %s\n", (int)i, base_classes[i].c_str());
+            selection_text.cat_sprnt("%d. %s\n", (int)i, class_pool::name_of(base_classes[i]));
         }
         selection_text.cat_sprnt("\nEnter number (0-%d): ", (int)(base_classes.size() - 1));
 
@@ -616,24 +945,19 @@ private:
         const VTableInfo& vt = g_vtable_cache.vtables[n];
 
         if (vt.is_intermediate) {
-            if (vt.parent_vtable_addr == BADADDR || vt.parent_class.empty()) {
+            if (vt.parent_vtable_addr == BADADDR || vt.parent_id == class_pool::NO_CLASS) {
                 warning("Intermediate class %s has no parent vtable to compare",
-                       vt.class_name.c_str());
+                       vt.class_name());
                 return;
             }
 
             ea_t parent_parent_vtable = BADADDR;
-            std::string parent_parent_name;
-
-            for (const auto& other : g_vtable_cache.vtables) {
-                if (other.class_name == vt.parent_class && !other.is_intermediate) {
-                    if (!other.base_classes.empty()) {
-                        parent_parent_name = other.base_classes[0];
-                        parent_parent_vtable = vtable_comparison::find_vtable_by_class_name(
-                            parent_parent_name, g_vtable_cache.vtables);
-                    }
-                    break;
-                }
+            class_pool::class_id_t parent_parent_id = class_pool::NO_CLASS;
+
+            const VTableInfo* parent = g_vtable_cache.find_by_class(vt.parent_id);
+            if (parent && !parent->is_intermediate && !parent->base_ids.empty()) {
+                parent_parent_id = parent->base_ids[0];
+                parent_parent_vtable = g_vtable_cache.vtable_of(parent_parent_id);
             }
 
             if (parent_parent_vtable == BADADDR) {
@@ -642,15 +966,15 @@ private:
                      "Parent: %s @ 0x%llX\n\n"
                      "No grandparent vtable found for comparison.\n"
                      "Use 'Browse Functions' to see inherited functions.",
-                     vt.class_name.c_str(), vt.parent_class.c_str(),
+                     vt.class_name(), vt.parent_class(),
                      (unsigned long long)vt.parent_vtable_addr);
                 return;
             }
 
-            auto comp = vtable_comparison::compare_vtables(
+            auto comp = g_vtable_cache.compare(
                 vt.parent_vtable_addr, parent_parent_vtable, vt.is_windows,
-                g_vtable_cache.sorted_addrs,
-                vt.class_name + " (via " + vt.parent_class + ")", parent_parent_name
+                std::string(vt.class_name()) + " (via " + vt.parent_class() + ")",
+                class_pool::name_of(parent_parent_id)
             );
 
             if (comp.entries.empty()) {
@@ -663,33 +987,31 @@ private:
             return;
         }
 
-        if (vt.base_classes.empty()) {
+        if (vt.base_ids.empty()) {
             warning("No base classes found for %s\n\n"
                    "This class either:\n"
                    "- Has no inheritance\n"
                    "- Was compiled without RTTI\n"
                    "- Has stripped RTTI information",
-                   vt.class_name.c_str());
+                   vt.class_name());
             return;
         }
 
-        std::string selected_base;
-        if (!select_base_class(vt.base_classes, selected_base)) {
+        class_pool::class_id_t selected_base = class_pool::NO_CLASS;
+        if (!select_base_class(vt.base_ids, selected_base)) {
             return;
         }
 
-        ea_t base_vtable = vtable_comparison::find_vtable_by_class_name(
-            selected_base, g_vtable_cache.vtables);
+        ea_t base_vtable = g_vtable_cache.vtable_of(selected_base);
 
         if (base_vtable == BADADDR) {
-            warning("Could not find vtable for base class: %s", selected_base.c_str());
+            warning("Could not find vtable for base class: %s", class_pool::name_of(selected_base));
             return;
         }
 
-        auto comp = vtable_comparison::compare_vtables(
+        auto comp = g_vtable_cache.compare(
             vt.address, base_vtable, vt.is_windows,
-            g_vtable_cache.sorted_addrs,
-            vt.class_name, selected_base
+            vt.class_name(), class_pool::name_of(selected_base)
         );
 
         if (comp.entries.empty()) {
@@ -718,32 +1040,36 @@ public:
 
         ea_t browse_addr = vt.is_intermediate ? vt.parent_vtable_addr : vt.address;
         if (browse_addr == BADADDR) {
-            warning("No vtable address available for %s", vt.class_name.c_str());
+            warning("No vtable address available for %s", vt.class_name());
             return;
         }
 
-        auto entries = smart_annotator::get_vtable_entries(browse_addr, vt.is_windows, g_vtable_cache.sorted_addrs);
+        auto entries = g_vtable_cache.entries_of(browse_addr, vt.is_windows);
         if (entries.empty()) {
             warning("No functions found in vtable");
             return;
         }
 
-        vtable_comparison::VTableComparison* comp_ptr = nullptr;
-        vtable_comparison::VTableComparison comp_data;
-
-        std::string base_for_comp = vt.is_intermediate ? vt.parent_class :
-                                    (!vt.base_classes.empty() ? vt.base_classes[0] : "");
-        if (!base_for_comp.empty()) {
-            ea_t base_vtable = vtable_comparison::find_vtable_by_class_name(base_for_comp, g_vtable_cache.vtables);
+        std::map<int, vtable_comparison::OverrideStatus> statuses;
+
+        class_pool::class_id_t base_for_comp = vt.is_intermediate ? vt.parent_id :
+                                    (!vt.base_ids.empty() ? vt.base_ids[0] : class_pool::NO_CLASS);
+        if (base_for_comp != class_pool::NO_CLASS && !vt.is_intermediate) {
+            const auto& overrides = g_vtable_cache.override_table();
+            if (const auto* edge = overrides.find(vt.class_id, base_for_comp, browse_addr))
+                overrides.fill_status_map(*edge, statuses);
+        } else if (base_for_comp != class_pool::NO_CLASS) {
+            // Intermediates borrow a parent's vtable, which is not a hierarchy edge
+            ea_t base_vtable = g_vtable_cache.vtable_of(base_for_comp);
             if (base_vtable != BADADDR) {
-                comp_data = vtable_comparison::compare_vtables(
-                    browse_addr, base_vtable, vt.is_windows,
-                    g_vtable_cache.sorted_addrs, vt.class_name, base_for_comp);
-                comp_ptr = &comp_data;
+                auto comp = g_vtable_cache.compare(
+                    browse_addr, base_vtable, vt.is_windows, vt.class_name(), class_pool::name_of(base_for_comp));
+                for (const auto& entry : comp.entries)
+                    statuses[entry.index] = entry.status;
             }
         }
 
-        func_browser_t *browser = new func_browser_t(vt.class_name, browse_addr, entries, comp_ptr);
+        func_browser_t *browser = new func_browser_t(vt.class_name(), browse_addr, entries, std::move(statuses));
         browser->choose();
     }
 
@@ -752,60 +1078,30 @@ public:
     }
 
     void annotate_all_vtables() {
+        g_vtable_cache.ensure();  // apply IDB edits made while the chooser was open
         if (g_vtable_cache.vtables.empty()) return;
 
         show_wait_box("Annotating all vtables...");
 
-        int total_funcs = 0;
-        int total_vtables = 0;
+        // Phase 1: every comment, computed off the IDB
+        g_vtable_cache.ensure_slots();
+        const auto& overrides = g_vtable_cache.override_table();
+        const auto plan = annotation_plan::build(g_vtable_cache.vtables, overrides, g_vtable_cache.slots,
+                                                 g_vtable_cache.sorted_addrs);
 
-        for (const auto &vt : g_vtable_cache.vtables) {
-            if (vt.is_intermediate) continue;
-
-            // Get base class for comparison (same logic as function browser)
-            std::map<int, int> status_map;
-            std::string base_for_comp = !vt.base_classes.empty() ? vt.base_classes[0] : "";
-            if (!base_for_comp.empty()) {
-                ea_t base_vtable = vtable_comparison::find_vtable_by_class_name(base_for_comp, g_vtable_cache.vtables);
-                if (base_vtable != BADADDR) {
-                    auto comp = vtable_comparison::compare_vtables(
-                        vt.address, base_vtable, vt.is_windows,
-                        g_vtable_cache.sorted_addrs, vt.class_name, base_for_comp);
-
-                    // Build status map from comparison entries
-                    for (const auto& entry : comp.entries) {
-                        status_map[entry.index] = static_cast<int>(entry.status);
-                    }
-                }
-            }
-
-            // Add vtable header comment with parent class info
-            char vtable_cmt[256];
-            if (!base_for_comp.empty()) {
-                qsnprintf(vtable_cmt, sizeof(vtable_cmt), "vtable for '%s' : inherits '%s'",
-                         vt.class_name.c_str(), base_for_comp.c_str());
-            } else {
-                qsnprintf(vtable_cmt, sizeof(vtable_cmt), "vtable for '%s' : (root class)",
-                         vt.class_name.c_str());
-            }
-            set_cmt(vt.address, vtable_cmt, false);
-
-            int count = smart_annotator::annotate_vtable(vt.address, vt.is_windows, g_vtable_cache.sorted_addrs,
-                                                         status_map.empty() ? nullptr : &status_map);
-            total_funcs += count;
-            total_vtables++;
-
-            if (user_cancelled()) {
-                hide_wait_box();
-                info("Annotation cancelled.\n\nVTables annotated: %d / %d\nFunctions annotated: %d",
-                     total_vtables, (int)g_vtable_cache.vtables.size(), total_funcs);
-                return;
-            }
-        }
+        // Phase 2: one batched write
+        replace_wait_box("Writing %d comments...", (int)plan.eas.size());
+        const auto result = annotation_plan::apply(plan);
 
         hide_wait_box();
-        info("All VTables Annotated!\n\nVTables processed: %d\nTotal functions annotated: %d",
-             total_vtables, total_funcs);
+        if (result.cancelled) {
+            info("Annotation cancelled.\n\nComments written: %d / %d\nAlready up to date: %d",
+                 (int)result.written, (int)plan.eas.size(), (int)result.unchanged);
+            return;
+        }
+        info("All VTables Annotated!\n\nVTables processed: %d\nTotal functions annotated: %d\n"
+             "Comments written: %d (%d already up to date)",
+             plan.vtable_count, plan.func_count, (int)result.written, (int)result.unchanged);
     }
 };
 
@@ -814,6 +1110,8 @@ static vtable_chooser_t* g_chooser = nullptr;
 inline void show_vtable_chooser() {
     if (!g_chooser) {
         g_chooser = new vtable_chooser_t();
+    } else {
+        g_vtable_cache.ensure();  // picks up IDB edits made since the last open, or rescans
     }
     g_chooser->choose();
 }
@@ -5,6 +5,7 @@
 #include <map>
 #include "rtti_parser.h"
 #include "smart_annotator.h"
+#include "thunk_resolver.h"
 #include "vtable_utils.h"
 
 namespace vtable_comparison {
@@ -47,9 +48,11 @@ inline std::string get_func_name(ea_t func) {
     return get_name(&name, func) ? std::string(name.c_str()) : "";
 }
 
-inline VTableComparison compare_vtables(
-    ea_t derived_vt, ea_t base_vt, bool is_win,
-    const std::vector<ea_t>& sorted,
+// Compares already decoded entries (e.g. from the slot cache)
+inline VTableComparison compare_entries(
+    const std::vector<smart_annotator::VTableEntry>& derived_entries,
+    const std::vector<smart_annotator::VTableEntry>& base_entries,
+    ea_t derived_vt, ea_t base_vt,
     const std::string& derived_cls = "",
     const std::string& base_cls = "")
 {
@@ -60,9 +63,6 @@ inline VTableComparison compare_vtables(
     r.base_vtable = base_vt;
     r.inherited_count = r.overridden_count = r.new_virtual_count = 0;
 
-    auto derived_entries = smart_annotator::get_vtable_entries(derived_vt, is_win, sorted);
-    auto base_entries = smart_annotator::get_vtable_entries(base_vt, is_win, sorted);
-
     std::map<int, smart_annotator::VTableEntry> base_map;
     for (const auto& e : base_entries) base_map[e.index] = e;
 
@@ -82,7 +82,8 @@ inline VTableComparison compare_vtables(
             c.is_pure_virtual_base = b.is_pure_virtual;
             c.base_func_name = get_func_name(b.func_ptr);
 
-            if (c.derived_func_ptr == c.base_func_ptr) {
+            // Adjustor thunks and jump stubs to the same function are not overrides
+            if (thunk_resolver::g_thunks.same_function(c.derived_func_ptr, c.base_func_ptr)) {
                 c.status = OverrideStatus::INHERITED;
                 r.inherited_count++;
             } else {
@@ -106,10 +107,15 @@ inline VTableComparison compare_vtables(
     return r;
 }
 
-inline ea_t find_vtable_by_class_name(const std::string& name, const std::vector<VTableInfo>& vtables) {
-    for (const auto& vt : vtables)
-        if (vt.class_name == name) return vt.address;
-    return BADADDR;
+inline VTableComparison compare_vtables(
+    ea_t derived_vt, ea_t base_vt, bool is_win,
+    const std::vector<ea_t>& sorted,
+    const std::string& derived_cls = "",
+    const std::string& base_cls = "")
+{
+    return compare_entries(smart_annotator::get_vtable_entries(derived_vt, is_win, sorted),
+                           smart_annotator::get_vtable_entries(base_vt, is_win, sorted),
+                           derived_vt, base_vt, derived_cls, base_cls);
 }
 
 inline const char* get_status_string(OverrideStatus s) {
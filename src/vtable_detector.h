@@ -7,29 +7,40 @@
 #include <segment.hpp>
 #include <funcs.hpp>
 #include <bytes.hpp>
-#include <xref.hpp>
 #include <vector>
 #include <string>
 #include <map>
 #include <algorithm>
+#include <iterator>
 #include "vtable_utils.h"
+#include "class_pool.h"
 #include "rtti_parser.h"
+#include "pointer_index.h"
+#include "vtable_discovery.h"
+#include "name_parser.h"
 
 struct VTableInfo {
     ea_t address;
-    std::string class_name;
-    std::string display_name;
+    class_pool::class_id_t class_id;
+    class_pool::class_id_t display_id;   // class_id, or "Parent::Class" for intermediates
     bool is_windows;
     int func_count;
     int pure_virtual_count;
-    std::vector<std::string> base_classes;
-    std::vector<std::string> derived_classes;
+    std::vector<class_pool::class_id_t> base_ids;
+    std::vector<class_pool::class_id_t> derived_ids;
     int derived_count;
     bool has_multiple_inheritance;
     bool has_virtual_inheritance;
     bool is_intermediate;        // True if class has no vtable but exists in RTTI chain
     ea_t parent_vtable_addr;     // For intermediate: parent's vtable address
-    std::string parent_class;    // Direct parent class name
+    class_pool::class_id_t parent_id;    // Direct parent class, NO_CLASS if none
+    int confidence;              // 0-100: SYMBOL_CONFIDENCE when named by a symbol or RTTI, else discovery score
+    std::vector<ea_t> secondary_vftables;  // MSVC: the class's other vftables, one per base subobject, by address
+
+    // Names are materialized from the class pool at the UI/JSON boundary
+    const char* class_name() const { return class_pool::name_of(class_id); }
+    const char* display_name() const { return class_pool::name_of(display_id); }
+    const char* parent_class() const { return class_pool::name_of(parent_id); }
 };
 
 namespace vtable_detector {
@@ -57,37 +68,53 @@ inline bool is_valid_class_name(const std::string& name) {
     return alnum_count > 0 && !all_same;
 }
 
-inline std::string extract_class_name(const char* mangled_name, bool& is_windows) {
-    using namespace vtable_utils;
-
+inline std::string strip_ptr_suffix(const char* mangled_name) {
     std::string sym_name(mangled_name);
-    is_windows = false;
-
     if (sym_name.length() > 4 && sym_name.compare(sym_name.length() - 4, 4, "_ptr") == 0)
         sym_name.resize(sym_name.length() - 4);
+    return sym_name;
+}
 
-    qstring demangled;
-    if (demangle_name(&demangled, sym_name.c_str(), MNG_NODEFINIT) > 0) {
-        const char* dem = demangled.c_str();
+// Class name from demangler output ("vtable for X" / "const X::`vftable'")
+inline std::string class_from_demangled(const char* dem, bool& is_windows) {
+    const char* vtable_pos = strstr(dem, "vtable for ");
+    if (vtable_pos) {
+        std::string class_name(vtable_pos + 11);
+        class_name = normalize_msvc_nested_class(class_name);
+        if (is_valid_class_name(class_name)) return class_name;
+    }
 
-        const char* vtable_pos = strstr(dem, "vtable for ");
-        if (vtable_pos) {
-            std::string class_name(vtable_pos + 11);
-            class_name = normalize_msvc_nested_class(class_name);
+    const char* vft_pos = strstr(dem, "::`vftable'");
+    if (vft_pos) {
+        is_windows = true;
+        const char* const_pos = strstr(dem, "const ");
+        if (const_pos && const_pos < vft_pos) {
+            std::string class_name(const_pos + 6, vft_pos - const_pos - 6);
+            class_name = normalize_msvc_nested_class(class_name);  // @ -> ::
             if (is_valid_class_name(class_name)) return class_name;
         }
-
-        const char* vft_pos = strstr(dem, "::`vftable'");
-        if (vft_pos) {
-            is_windows = true;
-            const char* const_pos = strstr(dem, "const ");
-            if (const_pos && const_pos < vft_pos) {
-                std::string class_name(const_pos + 6, vft_pos - const_pos - 6);
-                class_name = normalize_msvc_nested_class(class_name);  // @ -> ::
-                if (is_valid_class_name(class_name)) return class_name;
-            }
-        }
     }
+    return "";
+}
+
+// class_from_demangled() without the demangler, for the symbol forms
+// name_parser covers. Returns false when the symbol needs demangle_name().
+// Pure string work, safe to run on worker threads.
+inline bool class_from_parser(const std::string& sym, std::string& class_name, bool& is_windows) {
+    char buf[name_parser::NAME_BUFFER_SIZE];
+    const size_t n = name_parser::class_of_symbol(sym, buf, sizeof(buf));
+    if (!n) return false;
+
+    if (sym[0] == '?') is_windows = true;
+    class_name = normalize_msvc_nested_class(std::string_view(buf, n));
+    if (!is_valid_class_name(class_name)) class_name.clear();
+    return true;
+}
+
+// Manual _ZTV parser, used when the demangler gives nothing usable.
+// Pure string work, safe to run on worker threads.
+inline std::string extract_class_name_manual(const std::string& sym_name) {
+    using namespace vtable_utils;
 
     if (sym_name.compare(0, 4, "_ZTV") != 0) return "";
 
@@ -137,21 +164,130 @@ inline std::string extract_class_name(const char* mangled_name, bool& is_windows
     return "";
 }
 
-inline std::vector<VTableInfo> find_vtables() {
+inline std::string extract_class_name(const char* mangled_name, bool& is_windows) {
+    std::string sym_name = strip_ptr_suffix(mangled_name);
+    is_windows = false;
+
+    std::string class_name;
+    if (!class_from_parser(sym_name, class_name, is_windows)) {
+        qstring demangled;
+        if (demangle_name(&demangled, sym_name.c_str(), MNG_NODEFINIT) > 0)
+            class_name = class_from_demangled(demangled.c_str(), is_windows);
+    }
+    if (!class_name.empty()) return class_name;
+
+    return extract_class_name_manual(sym_name);
+}
+
+enum class symbol_kind_t : uint8 {
+    GCC_VTABLE,      // _ZTV...
+    MSVC_VTABLE,     // ??_7...
+    GENERIC_VTABLE,  // *vftable* / *vtbl*
+    MSVC_COL,        // ??_R4...
+    GCC_TYPEINFO,    // _ZTI...
+};
+
+// Result of classifying one name list entry, everything except the demangle step
+struct symbol_candidate_t {
+    size_t index;
+    symbol_kind_t kind;
+    std::string symbol;    // demangler input (_ptr suffix stripped)
+    std::string manual;    // extract_class_name_manual() result
+    std::string fallback;  // class name used when nothing else resolves
+    bool parsed = false;   // name_parser handled the symbol, `parsed_class` replaces the demangler
+    std::string parsed_class{};
+};
+
+inline void classify_symbols(const vtable_utils::name_snapshot_t& names, size_t begin, size_t end,
+                             std::vector<symbol_candidate_t>& out)
+{
+    for (size_t i = begin; i < end; ++i) {
+        const char* name = names.name(i);
+        if (!*name) continue;
+
+        if (strncmp(name, "_ZTV", 4) == 0) {
+            symbol_candidate_t c{i, symbol_kind_t::GCC_VTABLE, strip_ptr_suffix(name), "", ""};
+            bool is_windows = false;
+            c.parsed = class_from_parser(c.symbol, c.parsed_class, is_windows);
+            c.manual = extract_class_name_manual(c.symbol);
+            out.push_back(std::move(c));
+        }
+        else if (strncmp(name, "??_7", 4) == 0) {
+            symbol_candidate_t c{i, symbol_kind_t::MSVC_VTABLE, strip_ptr_suffix(name), "", ""};
+            bool is_windows = false;
+            c.parsed = class_from_parser(c.symbol, c.parsed_class, is_windows);
+            const char* marker = strstr(name, "@@6B@");
+            if (marker)
+                c.fallback = normalize_msvc_nested_class(std::string_view(name + 4, marker - name - 4));
+            out.push_back(std::move(c));
+        }
+        else if (strstr(name, "vftable") || strstr(name, "vtbl")) {
+            symbol_candidate_t c{i, symbol_kind_t::GENERIC_VTABLE, strip_ptr_suffix(name), "", ""};
+            c.fallback = normalize_msvc_nested_class(name);
+            out.push_back(std::move(c));
+        }
+
+        if (strncmp(name, "??_R4", 5) == 0)
+            out.push_back({i, symbol_kind_t::MSVC_COL, "", "", ""});
+        else if (strncmp(name, "_ZTI", 4) == 0)
+            out.push_back({i, symbol_kind_t::GCC_TYPEINFO, "", "", ""});
+    }
+}
+
+// Names whose appearance or removal changes which vtables exist or how their RTTI parses
+inline bool is_structural_symbol(const char* name) {
+    if (!name || !*name) return false;
+    return strncmp(name, "_ZTV", 4) == 0 || strncmp(name, "??_7", 4) == 0 || strncmp(name, "_ZTI", 4) == 0 ||
+           strncmp(name, "_ZTC", 4) == 0 || strncmp(name, "_ZTT", 4) == 0 ||
+           strncmp(name, "??_R4", 5) == 0 || strstr(name, "vftable") || strstr(name, "vtbl") ||
+           strstr(name, "class_type_info");
+}
+
+// Snapshots the name list and classifies it, in parallel unless g_parallel_scan is off.
+// Candidates come back in name list order regardless of how the work was split.
+inline std::vector<symbol_candidate_t> collect_symbol_candidates(const vtable_utils::name_snapshot_t& names) {
     using namespace vtable_utils;
 
-    std::vector<VTableInfo> vtables;
-    std::map<std::string, ea_t> seen;
+    std::vector<std::vector<symbol_candidate_t>> chunks(parallel_chunks(names.size()));
+    parallel_for(names.size(), [&](size_t chunk, size_t begin, size_t end) {
+        classify_symbols(names, begin, end, chunks[chunk]);
+    });
+
+    std::vector<symbol_candidate_t> merged;
+    size_t total = 0;
+    for (const auto& c : chunks) total += c.size();
+    merged.reserve(total);
+    for (auto& c : chunks)
+        std::move(c.begin(), c.end(), std::back_inserter(merged));
+    return merged;
+}
 
-    const size_t name_count = get_nlist_size();
-    vtables.reserve(name_count / VTABLE_RESERVE_RATIO);
+inline std::vector<VTableInfo> find_vtables(const vtable_utils::name_snapshot_t& names) {
+    using namespace vtable_utils;
 
-    auto add_vtable = [&](ea_t ea, const std::string& class_name, bool is_win) {
-        if (seen.emplace(class_name, ea).second) {
+    constexpr uint32 NOT_SEEN = UINT32_MAX;
+    std::vector<VTableInfo> vtables;
+    std::vector<uint32> position;  // class ID -> index into vtables, NOT_SEEN before its first vtable
+
+    const std::vector<symbol_candidate_t> candidates = collect_symbol_candidates(names);
+    vtables.reserve(names.size() / VTABLE_RESERVE_RATIO);
+
+    auto add_vtable = [&](ea_t ea, const std::string& class_name, bool is_win, int confidence = SYMBOL_CONFIDENCE) {
+        const class_pool::class_id_t id = class_pool::intern(class_name);
+        if (id >= position.size()) position.resize(id + 1, NOT_SEEN);
+        if (position[id] != NOT_SEEN) {
+            // MSVC emits one vftable per base subobject; they all name the same class
+            VTableInfo& known = vtables[position[id]];
+            auto& others = known.secondary_vftables;
+            if (is_win && known.is_windows && ea != known.address &&
+                std::find(others.begin(), others.end(), ea) == others.end())
+                others.push_back(ea);
+        } else {
+            position[id] = uint32(vtables.size());
             VTableInfo vt;
             vt.address = ea;
-            vt.class_name = class_name;
-            vt.display_name = class_name;
+            vt.class_id = id;
+            vt.display_id = id;
             vt.is_windows = is_win;
             vt.func_count = 0;
             vt.pure_virtual_count = 0;
@@ -160,124 +296,217 @@ inline std::vector<VTableInfo> find_vtables() {
             vt.has_virtual_inheritance = false;
             vt.is_intermediate = false;
             vt.parent_vtable_addr = BADADDR;
+            vt.parent_id = class_pool::NO_CLASS;
+            vt.confidence = confidence;
             vtables.push_back(std::move(vt));
         }
     };
 
-    for (size_t i = 0; i < name_count; ++i) {
-        const char* name = get_nlist_name(i);
-        if (!name || !*name) continue;
+    // Every address already reported, secondary vftables included, sorted.
+    // Passes keyed by address need it: the same vtable can reach them under
+    // a differently spelled class name (demangled _ZTV vs. typeinfo string)
+    auto known_addresses = [&] {
+        std::vector<ea_t> known;
+        known.reserve(vtables.size());
+        for (const auto& vt : vtables) {
+            known.push_back(vt.address);
+            known.insert(known.end(), vt.secondary_vftables.begin(), vt.secondary_vftables.end());
+        }
+        std::sort(known.begin(), known.end());
+        return known;
+    };
+
+    // Merge in name list order so dedupe picks the same entries as a serial walk.
+    // Demangling stays here: demangle_name() is a kernel call. Symbols the
+    // name parser already resolved on the workers skip it.
+    for (const auto& c : candidates) {
+        if (c.kind == symbol_kind_t::MSVC_COL || c.kind == symbol_kind_t::GCC_TYPEINFO) continue;
 
-        ea_t ea = get_nlist_ea(i);
         bool is_windows = false;
         std::string class_name;
-
-        if (strncmp(name, "_ZTV", 4) == 0) {
-            class_name = extract_class_name(name, is_windows);
-            if (is_valid_class_name(class_name))
-                add_vtable(ea, class_name, false);
+        if (c.parsed) {
+            class_name = c.parsed_class;
+        } else {
+            qstring demangled;
+            if (demangle_name(&demangled, c.symbol.c_str(), MNG_NODEFINIT) > 0)
+                class_name = class_from_demangled(demangled.c_str(), is_windows);
         }
-        else if (strncmp(name, "??_7", 4) == 0) {
-            class_name = extract_class_name(name, is_windows);
-            if (class_name.empty()) {
-                const char* marker = strstr(name, "@@6B@");
-                if (marker) {
-                    class_name.assign(name + 4, marker - name - 4);
-                    class_name = normalize_msvc_nested_class(class_name);
-                }
-            }
-            if (is_valid_class_name(class_name))
-                add_vtable(ea, class_name, true);
+        if (class_name.empty())
+            class_name = c.manual;
+
+        if (class_name.empty() && c.kind != symbol_kind_t::GCC_VTABLE) {
+            class_name = c.fallback;
+            if (c.kind == symbol_kind_t::GENERIC_VTABLE) is_windows = true;
         }
-        else if (strstr(name, "vftable") || strstr(name, "vtbl")) {
-            class_name = extract_class_name(name, is_windows);
-            if (class_name.empty()) {
-                class_name = name;
-                is_windows = true;
-                class_name = normalize_msvc_nested_class(class_name);
-            }
-            if (is_valid_class_name(class_name))
-                add_vtable(ea, class_name, is_windows);
+
+        if (!is_valid_class_name(class_name)) continue;
+
+        switch (c.kind) {
+            case symbol_kind_t::GCC_VTABLE:  add_vtable(names.ea(c.index), class_name, false); break;
+            case symbol_kind_t::MSVC_VTABLE: add_vtable(names.ea(c.index), class_name, true); break;
+            default:                         add_vtable(names.ea(c.index), class_name, is_windows); break;
         }
     }
 
-    // Second pass: discover vtables from ??_R4 (RTTI Complete Object Locator)
-    // symbols that have no corresponding ??_7 vtable symbol
-    for (size_t i = 0; i < name_count; ++i) {
-        const char* name = get_nlist_name(i);
-        if (!name || strncmp(name, "??_R4", 5) != 0) continue;
-
-        ea_t col_ea = get_nlist_ea(i);
-        if (!rtti_detector::validate_msvc_col(col_ea)) continue;
+    // Second pass: discover vtables from RTTI Complete Object Locators that have
+    // no corresponding ??_7 vtable symbol: ??_R4 symbols first, then, on PE
+    // images, locators found by signature in stripped .rdata
+    memory_image::image_scope_t image;
+    pointer_index::index_scope_t pointers;  // shared by the remaining passes
+    const int ps = get_ptr_size();
+
+    std::vector<std::pair<ea_t, const char*>> cols;  // COL, ??_R4 name or nullptr
+    for (const auto& c : candidates) {
+        if (c.kind != symbol_kind_t::MSVC_COL) continue;
+        ea_t col_ea = names.ea(c.index);
+        if (rtti_detector::validate_msvc_col(col_ea))
+            cols.emplace_back(col_ea, names.name(c.index));
+    }
+    if (rtti_detector::is_pe_file()) {
+        std::vector<ea_t> named;
+        for (const auto& c : cols) named.push_back(c.first);
+        std::sort(named.begin(), named.end());
+        for (ea_t col : vtable_discovery::find_msvc_cols())
+            if (!std::binary_search(named.begin(), named.end(), col))
+                cols.emplace_back(col, nullptr);
+    }
 
+    for (const auto& [col_ea, name] : cols) {
         // Read TypeDescriptor address from COL (+12 = type_descriptor RVA)
-        const int ps = get_ptr_size();
         const bool x64 = (ps == 8);
-        int32 td_rva = get_dword(col_ea + 12);
+        int32 td_rva = read_dword(col_ea + 12);
 
         ea_t td;
         if (x64) {
-            ea_t base = get_imagebase();
+            ea_t base = image_base();
             if (base == BADADDR) continue;
             td = rtti_parser::msvc_rtti::rva_to_va(base, td_rva);
         } else {
             td = (ea_t)(uint32)td_rva;
         }
-        if (td == BADADDR || !is_mapped(td)) continue;
+        if (td == BADADDR || !is_addr_mapped(td)) continue;
 
         std::string class_name = rtti_parser::msvc_rtti::read_msvc_type_name(td);
         if (!is_valid_class_name(class_name)) continue;
-        if (seen.count(class_name)) continue;
+        // Classes already found still get located: secondary COLs lead to their other vftables
 
         // Locate vtable from COL
         ea_t vtable_addr = BADADDR;
 
         // Strategy C: construct matching ??_7 name from ??_R4 name
-        {
+        if (name) {
             std::string vt_sym = "??_7" + std::string(name + 5);
             ea_t ea = get_name_ea(BADADDR, vt_sym.c_str());
             if (ea != BADADDR)
                 vtable_addr = ea;
         }
 
-        // Strategy A: find data xrefs to the COL address
+        // Strategy A: pointers to the COL address (COL pointer sits at vtable - ptr_size)
         if (vtable_addr == BADADDR) {
-            xrefblk_t xb;
-            for (bool ok = xb.first_to(col_ea, XREF_DATA); ok; ok = xb.next_to()) {
-                // COL pointer sits at vtable - ptr_size, so vtable = xref + ptr_size
-                ea_t candidate = xb.from + ps;
+            pointer_index::g_pointer_index.for_each_source(col_ea, [&](ea_t from) {
+                ea_t candidate = from + ps;
                 ea_t first_entry = read_ptr(candidate);
-                if (first_entry == BADADDR || !is_mapped(first_entry)) continue;
+                if (first_entry == BADADDR || !is_addr_mapped(first_entry)) return true;
 
-                if (get_func(first_entry)) {
+                if (get_func(first_entry) || is_exec_addr(first_entry)) {
                     vtable_addr = candidate;
-                    break;
+                    return false;
                 }
-                segment_t* seg = getseg(first_entry);
-                if (seg && (seg->perm & SEGPERM_EXEC)) {
-                    vtable_addr = candidate;
-                    break;
-                }
-            }
+                return true;
+            });
         }
 
         if (vtable_addr == BADADDR) continue;
 
         // Validate: first vtable entry must point to executable code
         ea_t first_func = read_ptr(vtable_addr);
-        if (first_func == BADADDR || !is_mapped(first_func)) continue;
-        if (!get_func(first_func)) {
-            segment_t* seg = getseg(first_func);
-            if (!seg || !(seg->perm & SEGPERM_EXEC)) continue;
-        }
+        if (first_func == BADADDR || !is_addr_mapped(first_func)) continue;
+        if (!get_func(first_func) && !is_exec_addr(first_func)) continue;
 
         add_vtable(vtable_addr, class_name, true);
     }
 
+    // Third pass: Itanium vtables whose _ZTV symbol is gone but whose typeinfo
+    // is still there, from _ZTI symbols or, stripped, from the cxxabi typeinfo
+    // vtables that every class typeinfo object points into
+    if (!rtti_detector::is_pe_file()) {
+        std::vector<ea_t> typeinfos;
+        std::vector<ea_t> address_points;
+        for (const auto& c : candidates) {
+            if (c.kind == symbol_kind_t::GCC_TYPEINFO)
+                typeinfos.push_back(names.ea(c.index));
+            else if (c.kind == symbol_kind_t::GCC_VTABLE &&
+                     vtable_discovery::is_cxxabi_typeinfo_vtable_symbol(c.symbol.c_str()))
+                address_points.push_back(names.ea(c.index) + 2 * ps);
+        }
+        if (address_points.empty())
+            address_points = vtable_discovery::find_typeinfo_address_points();
+        std::sort(address_points.begin(), address_points.end());
+
+        const std::vector<ea_t> known = known_addresses();
+        for (const auto& tv : vtable_discovery::find_typeinfo_vtables(std::move(typeinfos), address_points)) {
+            // Found under its _ZTV symbol already, maybe as Foo<int*> where the typeinfo says Foo
+            if (std::binary_search(known.begin(), known.end(), tv.vtable)) continue;
+
+            // Same check as the COL pass: first vtable entry must point to executable code
+            const ea_t first_func = read_ptr(tv.vtable + 2 * ps);
+            if (!get_func(first_func) && !is_exec_addr(first_func)) continue;
+
+            const ea_t name = read_ptr(tv.typeinfo + ps);
+            std::string class_name =
+                rtti_parser::gcc_rtti::extract_class_from_mangled(rtti_parser::gcc_rtti::read_string(name));
+            if (!is_valid_class_name(class_name)) continue;
+            add_vtable(tv.vtable, class_name, false);
+        }
+    }
+
+    // Fourth pass: vtables without any symbol, found by sweeping read-only data
+    if (g_discover_unnamed) {
+        const std::vector<ea_t> known = known_addresses();
+
+        for (const auto& c : vtable_discovery::sweep()) {
+            // Already reported under a symbol placed anywhere in its header
+            auto it = std::lower_bound(known.begin(), known.end(), c.address);
+            if (it != known.end() && *it <= c.first_slot) continue;
+
+            const bool is_win = c.kind == vtable_discovery::header_kind_t::MSVC_COL;
+            int confidence = c.confidence;
+            std::string class_name = vtable_discovery::class_name_of(c);
+            if (!is_valid_class_name(class_name)) {
+                confidence = std::min(confidence, vtable_discovery::bare_confidence(c.slot_count));
+                if (confidence < DISCOVERY_MIN_CONFIDENCE) continue;
+                class_name = vtable_discovery::anonymous_class_name(c.address);
+            }
+            add_vtable(c.address, class_name, is_win, confidence);
+        }
+    }
+
+    // The vftable at COL offset 0 stands for the class, whichever was found first
+    for (auto& vt : vtables) {
+        auto& others = vt.secondary_vftables;
+        if (others.empty()) continue;
+        int32 offset = 0;
+        if (!rtti_detector::msvc_vftable_offset(vt.address, offset) || offset != 0) {
+            for (ea_t& other : others) {
+                if (rtti_detector::msvc_vftable_offset(other, offset) && offset == 0) {
+                    std::swap(vt.address, other);
+                    break;
+                }
+            }
+        }
+        std::sort(others.begin(), others.end());
+    }
+
     std::sort(vtables.begin(), vtables.end(),
-        [](const VTableInfo& a, const VTableInfo& b) { return a.class_name < b.class_name; });
+        [](const VTableInfo& a, const VTableInfo& b) { return class_pool::name_less(a.class_id, b.class_id); });
 
     return vtables;
 }
 
+inline std::vector<VTableInfo> find_vtables() {
+    vtable_utils::name_snapshot_t names;
+    names.capture();
+    return find_vtables(names);
+}
+
 } // namespace vtable_detector
@@ -0,0 +1,445 @@
+#pragma once
+#include <ida.hpp>
+#include <segment.hpp>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iterator>
+#include "memory_image.h"
+#include "vtable_utils.h"
+#include "rtti_detector.h"
+#include "rtti_parser.h"
+#include "pointer_index.h"
+
+// Symbol-less vtable discovery: sweeps read-only data for maximal runs of
+// pointers into executable segments and keeps the runs whose header looks
+// like a vtable's (MSVC COL pointer, or Itanium offset-to-top + typeinfo).
+
+namespace vtable_discovery {
+
+using vtable_utils::get_ptr_size;
+using vtable_utils::read_ptr;
+using vtable_utils::is_addr_mapped;
+using vtable_utils::is_exec_addr;
+using memory_image::span_t;
+using memory_image::collect_spans;
+using memory_image::for_each_piece;
+
+enum class header_kind_t : uint8 {
+    MSVC_COL,           // [COL*] slots...
+    ITANIUM_TYPEINFO,   // [0] [typeinfo*] slots...
+    ITANIUM_NO_RTTI,    // [0] [0] slots... (-fno-rtti)
+};
+
+struct candidate_t {
+    ea_t address;       // vtable address as the symbol passes report it
+    ea_t first_slot;
+    uint32 slot_count;
+    header_kind_t kind;
+    ea_t rtti;          // COL or typeinfo, BADADDR for ITANIUM_NO_RTTI
+    int confidence;     // 0-100
+};
+
+// Score of a run with no RTTI behind it: grows with its length
+inline int bare_confidence(uint32 slot_count) {
+    using namespace vtable_utils;
+    return DISCOVERY_BARE_BASE_CONFIDENCE +
+           int(std::min<uint32>(slot_count, DISCOVERY_BARE_SLOT_CAP)) * DISCOVERY_BARE_SLOT_CONFIDENCE;
+}
+
+// Mangled typeinfo name string: "7MyClass" / "N2ns5ClassE"
+inline bool looks_like_type_name(ea_t addr) {
+    if (!is_addr_mapped(addr)) return false;
+    const uint8 c = vtable_utils::read_byte(addr);
+    return (c >= '1' && c <= '9') || c == 'N';
+}
+
+// Classifies the words in front of a run. Kernel-free. Bare [0][0] headers
+// are an Itanium -fno-rtti shape, only looked for when allow_bare is set.
+inline bool classify_header(ea_t first_slot, uint32 slot_count, candidate_t& out, bool allow_bare) {
+    using namespace vtable_utils;
+    const int ps = get_ptr_size();
+
+    out.first_slot = first_slot;
+    out.slot_count = slot_count;
+
+    const ea_t prev = read_ptr(first_slot - ps);
+    if (prev != BADADDR && prev && !is_exec_addr(prev) && rtti_detector::validate_msvc_col(prev)) {
+        out.address = first_slot;
+        out.kind = header_kind_t::MSVC_COL;
+        out.rtti = prev;
+        out.confidence = DISCOVERY_RTTI_CONFIDENCE;
+        return true;
+    }
+
+    // Itanium: only primary vtables (offset-to-top 0) stand for a class of their own
+    if (!is_addr_mapped(first_slot - 2 * ps) || read_ptr(first_slot - 2 * ps) != 0) return false;
+    out.address = first_slot - 2 * ps;
+
+    if (prev == 0) {
+        if (!allow_bare || slot_count < DISCOVERY_MIN_BARE_SLOTS) return false;
+        out.kind = header_kind_t::ITANIUM_NO_RTTI;
+        out.rtti = BADADDR;
+        out.confidence = bare_confidence(slot_count);
+        return out.confidence >= DISCOVERY_MIN_CONFIDENCE;
+    }
+
+    if (prev == BADADDR || !is_addr_mapped(prev) || is_exec_addr(prev)) return false;
+    const ea_t name = read_ptr(prev + ps);
+    if (name == BADADDR || !looks_like_type_name(name)) return false;
+
+    out.kind = header_kind_t::ITANIUM_TYPEINFO;
+    out.rtti = prev;
+    out.confidence = DISCOVERY_RTTI_CONFIDENCE - 5;
+    return true;
+}
+
+// Segments worth sweeping: loaded, not executable and not writable (perm 0 =
+// unknown). ELF .data.rel.ro counts as read-only: it is mapped writable until
+// RELRO, and it is where PIE and shared-object vtables live.
+inline bool is_sweepable(const memory_image::image_segment_t& s) {
+    if (!s.loaded || (s.perm & SEGPERM_EXEC)) return false;
+    return s.perm == 0 || !(s.perm & SEGPERM_WRITE) || s.relro;
+}
+
+// Range-checks `n` words at `raw` against the executable segments, branch-free
+inline void exec_mask(const uint8* raw, size_t n, int ps,
+                      const std::vector<memory_image::addr_range_t>& ranges,
+                      std::vector<ea_t>& ptrs, std::vector<uint8>& mask)
+{
+    ptrs.resize(n);
+    mask.assign(n, 0);
+    if (ps == 8) {
+        for (size_t i = 0; i < n; ++i) {
+            uint64 v;
+            memcpy(&v, raw + i * 8, 8);
+            ptrs[i] = ea_t(v);
+        }
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            uint32 v;
+            memcpy(&v, raw + i * 4, 4);
+            ptrs[i] = ea_t(v);
+        }
+    }
+    const ea_t* p = ptrs.data();
+    uint8* m = mask.data();
+    for (const auto& r : ranges) {
+        const ea_t lo = r.start_ea;
+        const ea_t span = r.end_ea - r.start_ea;
+        for (size_t i = 0; i < n; ++i)
+            m[i] |= uint8((p[i] - lo) < span);
+    }
+}
+
+// Every candidate in the swept segments, in address order. Runs on the worker
+// pool over the concatenated word space of all sweepable segments; each chunk
+// reports the runs that start inside it. Needs memory_image::g_image loaded.
+inline std::vector<candidate_t> sweep() {
+    using namespace vtable_utils;
+    const auto& img = memory_image::g_image;
+    if (!img.valid) return {};
+
+    const int ps = get_ptr_size();
+    const bool allow_bare = !rtti_detector::is_pe_file();  // MSVC has no RTTI-less Itanium layout
+    std::vector<span_t> spans;
+    const size_t total = collect_spans(ps, is_sweepable, spans);
+
+    std::vector<std::vector<candidate_t>> chunks(parallel_chunks(total));
+    parallel_for(total, [&](size_t chunk, size_t begin, size_t end) {
+        std::vector<ea_t> ptrs;
+        std::vector<uint8> mask;
+        auto& out = chunks[chunk];
+
+        for_each_piece(spans, begin, end, [&](const span_t& sp, const uint8* base, size_t w, size_t stop) {
+            // A run already open at the chunk start belongs to the previous chunk
+            bool open = false;
+            if (w > 0) {
+                ea_t v = 0;
+                memcpy(&v, base + (w - 1) * ps, ps);
+                open = is_exec_addr(v);
+            }
+
+            while (w < stop) {
+                const size_t n = std::min<size_t>(DISCOVERY_BLOCK_WORDS, stop - w);
+                exec_mask(base + w * ps, n, ps, img.exec_ranges, ptrs, mask);
+
+                for (size_t i = 0; i < n; ++i) {
+                    if (!mask[i]) { open = false; continue; }
+                    if (open) continue;
+                    open = true;
+
+                    // Runs may continue past the block; measure the rest word by word
+                    size_t len = 1;
+                    while (i + len < n && mask[i + len]) ++len;
+                    while (i + len >= n && w + i + len < sp.words) {
+                        ea_t v = 0;
+                        memcpy(&v, base + (w + i + len) * ps, ps);
+                        if (!is_exec_addr(v)) break;
+                        ++len;
+                    }
+
+                    const size_t slot = w + i;
+                    if (slot < 1) continue;  // no room for a header
+                    candidate_t c;
+                    if (classify_header(sp.first_word + ea_t(slot) * ps, uint32(len), c, allow_bare))
+                        out.push_back(c);
+                }
+                w += n;
+            }
+        });
+    });
+
+    std::vector<candidate_t> merged;
+    for (auto& c : chunks)
+        std::move(c.begin(), c.end(), std::back_inserter(merged));
+    return merged;
+}
+
+// MSVC Complete Object Locator at ea whose TypeDescriptor carries a ".?A" name
+inline bool is_plausible_col(ea_t ea) {
+    using namespace vtable_utils;
+    if (!rtti_detector::validate_msvc_col(ea)) return false;
+
+    const int32 td_rva = (int32)read_dword(ea + 12);
+    ea_t td;
+    if (get_ptr_size() == 8) {
+        const ea_t base = image_base();
+        if (base == BADADDR) return false;
+        td = rtti_parser::msvc_rtti::rva_to_va(base, td_rva);
+    } else {
+        td = (ea_t)(uint32)td_rva;
+    }
+    if (td == BADADDR) return false;
+    const ea_t name = td + 2 * get_ptr_size();
+    return read_byte(name) == '.' && read_byte(name + 1) == '?' && read_byte(name + 2) == 'A';
+}
+
+// Complete Object Locators in read-only data, found by signature instead of
+// by ??_R4 symbols. Sorted. The first filter is a branch-free pass over
+// dword-aligned words: x64 COLs (signature 1) hold their own RVA at +20,
+// x86 COLs (signature 0) hold absolute TD/CHD pointers into the image.
+inline std::vector<ea_t> find_msvc_cols() {
+    using namespace vtable_utils;
+    const auto& img = memory_image::g_image;
+    if (!img.valid || img.segments.empty()) return {};
+
+    const bool x64 = get_ptr_size() == 8;
+    const ea_t imagebase = img.imagebase;
+    if (x64 && imagebase == BADADDR) return {};
+    const ea_t image_lo = img.segments.front().start_ea;
+    const ea_t image_span = img.segments.back().end_ea - image_lo;
+
+    std::vector<span_t> spans;
+    const size_t total = collect_spans(4, is_sweepable, spans);
+    constexpr size_t COL_DWORDS = 6;
+
+    std::vector<std::vector<ea_t>> chunks(parallel_chunks(total));
+    parallel_for(total, [&](size_t chunk, size_t begin, size_t end) {
+        std::vector<uint32> d;
+        std::vector<uint8> mask;
+        auto& out = chunks[chunk];
+
+        for_each_piece(spans, begin, end, [&](const span_t& sp, const uint8* base, size_t w, size_t stop) {
+            if (sp.words < COL_DWORDS) return;
+            stop = std::min(stop, sp.words - COL_DWORDS + 1);
+
+            while (w < stop) {
+                const size_t n = std::min<size_t>(DISCOVERY_BLOCK_WORDS, stop - w);
+                d.resize(n + COL_DWORDS);
+                memcpy(d.data(), base + w * 4, (n + COL_DWORDS - 1) * 4);
+                mask.assign(n, 0);
+
+                const ea_t first = sp.first_word + ea_t(w) * 4;
+                if (x64) {
+                    const uint32 rva0 = uint32(first - imagebase);
+                    for (size_t i = 0; i < n; ++i)
+                        mask[i] = uint8((d[i] == 1) & (d[i + 5] == rva0 + uint32(i * 4)));
+                } else {
+                    for (size_t i = 0; i < n; ++i)
+                        mask[i] = uint8((d[i] == 0) & ((ea_t(d[i + 3]) - image_lo) < image_span) &
+                                        ((ea_t(d[i + 4]) - image_lo) < image_span));
+                }
+
+                for (size_t i = 0; i < n; ++i) {
+                    if (mask[i] && is_plausible_col(first + ea_t(i) * 4))
+                        out.push_back(first + ea_t(i) * 4);
+                }
+                w += n;
+            }
+        });
+    });
+
+    std::vector<ea_t> merged;
+    for (auto& c : chunks)
+        merged.insert(merged.end(), c.begin(), c.end());
+    return merged;
+}
+
+// Start addresses of every occurrence of needle[0..len) in loaded non-executable data, sorted
+inline std::vector<ea_t> find_bytes(const char* needle, size_t len) {
+    using namespace vtable_utils;
+    if (!len || !memory_image::g_image.valid) return {};
+
+    std::vector<span_t> spans;
+    const size_t total = collect_spans(1, [](const memory_image::image_segment_t& s) {
+        return !(s.perm & SEGPERM_EXEC);
+    }, spans);
+
+    std::vector<std::vector<ea_t>> chunks(parallel_chunks(total));
+    parallel_for(total, [&](size_t chunk, size_t begin, size_t end) {
+        for_each_piece(spans, begin, end, [&](const span_t& sp, const uint8* base, size_t lo, size_t hi) {
+            // Matches start in [lo, hi) but may run on to the end of the segment
+            const uint8* seg_end = base + sp.words;
+            const uint8* p = base + lo;
+            const uint8* stop = base + hi;
+            while (p < stop) {
+                p = static_cast<const uint8*>(memchr(p, uint8(needle[0]), size_t(stop - p)));
+                if (!p) break;
+                if (size_t(seg_end - p) >= len && memcmp(p, needle, len) == 0)
+                    chunks[chunk].push_back(sp.first_word + ea_t(p - base));
+                ++p;
+            }
+        });
+    });
+
+    std::vector<ea_t> merged;
+    for (auto& c : chunks)
+        merged.insert(merged.end(), c.begin(), c.end());
+    return merged;
+}
+
+// Typeinfo classes of the Itanium ABI, by their mangled type names (the _ZTS
+// string contents). Class typeinfo objects start with a pointer to the address
+// point of one of their vtables.
+constexpr const char* CXXABI_TYPEINFO_CLASSES[] = {
+    "N10__cxxabiv117__class_type_infoE",
+    "N10__cxxabiv120__si_class_type_infoE",
+    "N10__cxxabiv121__vmi_class_type_infoE",
+};
+
+inline bool is_cxxabi_typeinfo_vtable_symbol(const char* name) {
+    if (strncmp(name, "_ZTV", 4) != 0) return false;
+    for (const char* cls : CXXABI_TYPEINFO_CLASSES)
+        if (strcmp(name + 4, cls) == 0) return true;
+    return false;
+}
+
+// Address points of the cxxabi typeinfo vtables in a stripped image: their
+// _ZTS strings, the typeinfo objects naming them (+ptr_size), then the
+// primary vtables referencing those (+ptr_size, offset-to-top 0). Sorted.
+// Needs pointer_index::g_pointer_index built.
+inline std::vector<ea_t> find_typeinfo_address_points() {
+    const int ps = get_ptr_size();
+
+    std::vector<ea_t> strings;
+    for (const char* cls : CXXABI_TYPEINFO_CLASSES) {
+        const auto hits = find_bytes(cls, strlen(cls) + 1);
+        strings.insert(strings.end(), hits.begin(), hits.end());
+    }
+    std::sort(strings.begin(), strings.end());
+    if (strings.empty()) return {};
+
+    const auto& refs = pointer_index::g_pointer_index;
+    std::vector<ea_t> abi_typeinfos;
+    for (ea_t str : strings)
+        refs.for_each_source(str, [&](ea_t src) { abi_typeinfos.push_back(src - ps); return true; });
+    std::sort(abi_typeinfos.begin(), abi_typeinfos.end());
+    abi_typeinfos.erase(std::unique(abi_typeinfos.begin(), abi_typeinfos.end()), abi_typeinfos.end());
+
+    std::vector<ea_t> points;
+    for (ea_t ti : abi_typeinfos) {
+        refs.for_each_source(ti, [&](ea_t src) {
+            if (read_ptr(src - ps) == 0)
+                points.push_back(src + ps);
+            return true;
+        });
+    }
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    return points;
+}
+
+// Itanium class typeinfo at ti: vptr into one of the address points, then a type name
+inline bool is_class_typeinfo(ea_t ti, const std::vector<ea_t>& address_points) {
+    const ea_t vptr = read_ptr(ti);
+    if (vptr == BADADDR) return false;
+    if (!address_points.empty() && !std::binary_search(address_points.begin(), address_points.end(), vptr))
+        return false;
+    const ea_t name = read_ptr(ti + get_ptr_size());
+    return name != BADADDR && looks_like_type_name(name);
+}
+
+struct typeinfo_vtable_t {
+    ea_t typeinfo;
+    ea_t vtable;   // offset-to-top slot, as _ZTV symbols are placed
+};
+
+// Primary vtables of class typeinfos: `typeinfos` come from _ZTI symbols,
+// more are found as objects whose first word is a typeinfo address point.
+// A vtable references its typeinfo at +ptr_size after an offset-to-top of 0.
+// Needs pointer_index::g_pointer_index built.
+inline std::vector<typeinfo_vtable_t> find_typeinfo_vtables(std::vector<ea_t> typeinfos,
+                                                            const std::vector<ea_t>& address_points)
+{
+    const int ps = get_ptr_size();
+
+    const auto& refs = pointer_index::g_pointer_index;
+    for (ea_t point : address_points)
+        refs.for_each_source(point, [&](ea_t src) { typeinfos.push_back(src); return true; });
+    std::sort(typeinfos.begin(), typeinfos.end());
+    typeinfos.erase(std::unique(typeinfos.begin(), typeinfos.end()), typeinfos.end());
+    typeinfos.erase(std::remove_if(typeinfos.begin(), typeinfos.end(),
+                                   [&](ea_t ti) { return !is_class_typeinfo(ti, address_points); }),
+                    typeinfos.end());
+
+    std::vector<typeinfo_vtable_t> out;
+    for (ea_t ti : typeinfos) {
+        refs.for_each_source(ti, [&](ea_t src) {
+            const ea_t vt = src - ps;
+            if (read_ptr(vt) != 0) return true;
+            const ea_t first = read_ptr(vt + 2 * ps);
+            if (first == BADADDR || !is_addr_mapped(first)) return true;
+            out.push_back({ti, vt});
+            return false;
+        });
+    }
+    return out;
+}
+
+// Class name from a candidate's RTTI; empty when there is none or it does not
+// parse. Main thread only (demangler).
+inline std::string class_name_of(const candidate_t& c) {
+    using namespace vtable_utils;
+    switch (c.kind) {
+        case header_kind_t::MSVC_COL: {
+            const int32 td_rva = (int32)read_dword(c.rtti + 12);
+            ea_t td;
+            if (get_ptr_size() == 8) {
+                const ea_t base = image_base();
+                if (base == BADADDR) return "";
+                td = rtti_parser::msvc_rtti::rva_to_va(base, td_rva);
+            } else {
+                td = (ea_t)(uint32)td_rva;
+            }
+            if (td == BADADDR || !is_addr_mapped(td)) return "";
+            return rtti_parser::msvc_rtti::read_msvc_type_name(td);
+        }
+        case header_kind_t::ITANIUM_TYPEINFO: {
+            const ea_t name = read_ptr(c.rtti + get_ptr_size());
+            if (name == BADADDR) return "";
+            return rtti_parser::gcc_rtti::extract_class_from_mangled(rtti_parser::gcc_rtti::read_string(name));
+        }
+        default:
+            return "";
+    }
+}
+
+// Placeholder class name for a vtable whose class is unknown
+inline std::string anonymous_class_name(ea_t vtable) {
+    char buf[32];
+    qsnprintf(buf, sizeof(buf), "_vtable_%llX", (unsigned long long)vtable);
+    return buf;
+}
+
+} // namespace vtable_discovery
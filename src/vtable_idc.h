@@ -3,6 +3,7 @@
 #include <expr.hpp>
 #include "vtable_chooser.h"
 #include "vtable_json.h"
+#include "name_check.h"
 
 // IDC functions exposing VTableExplorer data as JSON strings.
 // Call from IDAPython: idc.eval_idc('VTableExplorer_Scan()')
@@ -11,8 +12,7 @@ namespace vtable_idc {
 
 // Ensure the global cache is populated
 static void ensure_cache() {
-    if (!g_vtable_cache.valid)
-        g_vtable_cache.refresh();
+    g_vtable_cache.ensure();
 }
 
 // --- IDC function implementations ---
@@ -28,11 +28,7 @@ static error_t idaapi idc_entries(idc_value_t *argv, idc_value_t *res) {
     ensure_cache();
     ea_t addr = (ea_t)argv[0].num;
 
-    // Find the vtable info
-    const VTableInfo *vt = nullptr;
-    for (const auto &v : g_vtable_cache.vtables) {
-        if (v.address == addr) { vt = &v; break; }
-    }
+    const VTableInfo *vt = g_vtable_cache.find_by_address(addr);
     if (!vt) {
         res->_set_string(qstring("{\"error\":\"vtable not found\"}"));
         return eOk;
@@ -44,10 +40,9 @@ static error_t idaapi idc_entries(idc_value_t *argv, idc_value_t *res) {
         return eOk;
     }
 
-    auto entries = smart_annotator::get_vtable_entries(
-        browse_addr, vt->is_windows, g_vtable_cache.sorted_addrs);
+    auto entries = g_vtable_cache.entries_of(browse_addr, vt->is_windows);
     std::string json = vtable_json::vtable_entries_to_json(
-        browse_addr, vt->class_name, entries);
+        browse_addr, vt->class_name(), entries);
     res->_set_string(qstring(json.c_str()));
     return eOk;
 }
@@ -60,14 +55,14 @@ static error_t idaapi idc_compare(idc_value_t *argv, idc_value_t *res) {
     // Resolve class names
     std::string derived_name, base_name;
     bool is_windows = false;
-    for (const auto &v : g_vtable_cache.vtables) {
-        if (v.address == derived_addr) { derived_name = v.class_name; is_windows = v.is_windows; }
-        if (v.address == base_addr)    { base_name = v.class_name; }
+    if (const VTableInfo *v = g_vtable_cache.find_by_address(derived_addr)) {
+        derived_name = v->class_name();
+        is_windows = v->is_windows;
     }
+    if (const VTableInfo *v = g_vtable_cache.find_by_address(base_addr))
+        base_name = v->class_name();
 
-    auto cmp = vtable_comparison::compare_vtables(
-        derived_addr, base_addr, is_windows,
-        g_vtable_cache.sorted_addrs, derived_name, base_name);
+    auto cmp = g_vtable_cache.compare(derived_addr, base_addr, is_windows, derived_name, base_name);
     std::string json = vtable_json::vtable_comparison_to_json(cmp);
     res->_set_string(qstring(json.c_str()));
     return eOk;
@@ -77,7 +72,57 @@ static error_t idaapi idc_hierarchy(idc_value_t *argv, idc_value_t *res) {
     ensure_cache();
     std::string class_name(argv[0].c_str());
     std::string json = vtable_json::vtable_hierarchy_to_json(
-        class_name, g_vtable_cache.vtables);
+        class_name, g_vtable_cache.vtables, g_vtable_cache.hierarchy);
+    res->_set_string(qstring(json.c_str()));
+    return eOk;
+}
+
+static error_t idaapi idc_construction(idc_value_t * /*argv*/, idc_value_t *res) {
+    ensure_cache();
+    std::string json = vtable_json::construction_vtables_to_json();
+    res->_set_string(qstring(json.c_str()));
+    return eOk;
+}
+
+static error_t idaapi idc_stats(idc_value_t * /*argv*/, idc_value_t *res) {
+    ensure_cache();
+    using vtable_json::json_size;
+    const auto r = g_vtable_cache.memory_report();
+    std::string json = "{";
+    json += "\"vtable_count\":" + json_size(r.vtable_count);
+    json += ",\"class_count\":" + json_size(r.class_count);
+    json += ",\"class_refs\":" + json_size(r.class_refs);
+    json += ",\"pool_bytes\":" + json_size(r.pool_bytes);
+    json += ",\"vtable_bytes\":" + json_size(r.vtable_bytes);
+    json += ",\"slot_cache_bytes\":" + json_size(r.slot_cache_bytes);
+    json += ",\"rtti_cache_bytes\":" + json_size(r.rtti_cache_bytes);
+    json += ",\"rtti_records\":" + json_size(r.rtti_records);
+    json += ",\"group_bytes\":" + json_size(r.group_bytes);
+    json += ",\"secondary_vtables\":" + json_size(r.secondary_vtables);
+    json += ",\"construction_vtables\":" + json_size(r.construction_vtables);
+    json += ",\"resolved_thunks\":" + json_size(r.resolved_thunks);
+    json += ",\"string_equivalent_bytes\":" + json_size(r.string_equivalent_bytes);
+    json += "}";
+    res->_set_string(qstring(json.c_str()));
+    return eOk;
+}
+
+static error_t idaapi idc_name_check(idc_value_t * /*argv*/, idc_value_t *res) {
+    using vtable_json::json_size;
+    const auto r = name_check::run();
+    char timing[160];
+    qsnprintf(timing, sizeof(timing), ",\"fast_ns\":%.1f,\"demangle_ns\":%.1f,\"normalize_ns\":%.1f,\"clean_ns\":%.1f",
+              r.fast_ns, r.demangle_ns, r.normalize_ns, r.clean_ns);
+    std::string json = "{";
+    json += "\"checked\":" + json_size(r.checked);
+    json += ",\"fast_parsed\":" + json_size(r.fast_parsed);
+    json += ",\"compared\":" + json_size(r.compared);
+    json += ",\"mismatches\":" + json_size(r.mismatches);
+    json += ",\"golden_failures\":" + json_size(r.golden_failures);
+    json += ",\"transform_names\":" + json_size(r.transform_names);
+    json += ",\"examples\":" + vtable_json::string_array(r.examples);
+    json += timing;
+    json += "}";
     res->_set_string(qstring(json.c_str()));
     return eOk;
 }
@@ -88,12 +133,18 @@ static const char idc_scan_args[]      = { 0 };
 static const char idc_entries_args[]   = { VT_LONG, 0 };
 static const char idc_compare_args[]   = { VT_LONG, VT_LONG, 0 };
 static const char idc_hierarchy_args[] = { VT_STR, 0 };
+static const char idc_stats_args[]     = { 0 };
+static const char idc_construction_args[] = { 0 };
+static const char idc_name_check_args[] = { 0 };
 
 static const ext_idcfunc_t idc_funcs[] = {
     { "VTableExplorer_Scan",      idc_scan,      idc_scan_args,      nullptr, 0, EXTFUN_BASE },
     { "VTableExplorer_Entries",   idc_entries,   idc_entries_args,   nullptr, 0, EXTFUN_BASE },
     { "VTableExplorer_Compare",   idc_compare,   idc_compare_args,   nullptr, 0, EXTFUN_BASE },
     { "VTableExplorer_Hierarchy", idc_hierarchy, idc_hierarchy_args, nullptr, 0, EXTFUN_BASE },
+    { "VTableExplorer_Stats",     idc_stats,     idc_stats_args,     nullptr, 0, EXTFUN_BASE },
+    { "VTableExplorer_ConstructionVtables", idc_construction, idc_construction_args, nullptr, 0, EXTFUN_BASE },
+    { "VTableExplorer_NameCheck", idc_name_check, idc_name_check_args, nullptr, 0, EXTFUN_BASE },
 };
 
 inline void register_vtable_idc_functions() {
@@ -2,9 +2,12 @@
 #include <string>
 #include <vector>
 #include <ida.hpp>
+#include <name.hpp>
+#include <demangle.hpp>
 #include "vtable_detector.h"
 #include "smart_annotator.h"
 #include "vtable_comparison.h"
+#include "class_hierarchy.h"
 #include "vtable_utils.h"
 
 namespace vtable_json {
@@ -50,6 +53,12 @@ inline std::string json_int(int v) {
     return buf;
 }
 
+inline std::string json_size(size_t v) {
+    char buf[32];
+    qsnprintf(buf, sizeof(buf), "%llu", (unsigned long long)v);
+    return buf;
+}
+
 inline std::string string_array(const std::vector<std::string> &arr) {
     std::string out = "[";
     for (size_t i = 0; i < arr.size(); ++i) {
@@ -60,6 +69,36 @@ inline std::string string_array(const std::vector<std::string> &arr) {
     return out;
 }
 
+inline std::string class_array(const std::vector<class_pool::class_id_t> &ids) {
+    std::string out = "[";
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (i > 0) out += ",";
+        out += json_str(class_pool::name_of(ids[i]));
+    }
+    out += "]";
+    return out;
+}
+
+// Subobject vtables of a group, from index `from` on
+inline std::string subobject_array(const smart_annotator::vtable_group_t* g, uint32 from) {
+    std::string out = "[";
+    for (uint32 k = from; g && k < g->count; ++k) {
+        const auto& sub = smart_annotator::g_groups.subobjects[g->first + k];
+        if (k > from) out += ",";
+        out += "{\"address\":" + addr_str(sub.address);
+        out += ",\"offset\":" + json_int(int(sub.offset));
+        out += ",\"slot_count\":" + json_int(int(sub.slot_count));
+        out += "}";
+    }
+    out += "]";
+    return out;
+}
+
+// Secondary vtables of the class whose primary vtable is at vtable_addr (Itanium group or MSVC vftables)
+inline std::string secondary_array(ea_t vtable_addr) {
+    return subobject_array(smart_annotator::g_groups.find(vtable_addr), 1);
+}
+
 // --- Serialization functions ---
 
 inline std::string vtables_to_json(const std::vector<VTableInfo> &vtables) {
@@ -70,18 +109,44 @@ inline std::string vtables_to_json(const std::vector<VTableInfo> &vtables) {
         first = false;
         out += "{";
         out += "\"address\":" + addr_str(vt.address);
-        out += ",\"class_name\":" + json_str(vt.class_name);
-        out += ",\"display_name\":" + json_str(vt.display_name);
+        out += ",\"class_name\":" + json_str(vt.class_name());
+        out += ",\"display_name\":" + json_str(vt.display_name());
         out += ",\"func_count\":" + json_int(vt.func_count);
         out += ",\"pure_virtual_count\":" + json_int(vt.pure_virtual_count);
         out += ",\"is_abstract\":" + json_bool(vt.pure_virtual_count > 0);
-        out += ",\"base_classes\":" + string_array(vt.base_classes);
-        out += ",\"derived_classes\":" + string_array(vt.derived_classes);
+        out += ",\"base_classes\":" + class_array(vt.base_ids);
+        out += ",\"derived_classes\":" + class_array(vt.derived_ids);
         out += ",\"derived_count\":" + json_int(vt.derived_count);
         out += ",\"has_multiple_inheritance\":" + json_bool(vt.has_multiple_inheritance);
         out += ",\"has_virtual_inheritance\":" + json_bool(vt.has_virtual_inheritance);
         out += ",\"is_intermediate\":" + json_bool(vt.is_intermediate);
         out += ",\"is_windows\":" + json_bool(vt.is_windows);
+        out += ",\"confidence\":" + json_int(vt.confidence);
+        out += ",\"secondary_vtables\":" + secondary_array(vt.address);
+        out += "}";
+    }
+    out += "]";
+    return out;
+}
+
+// _ZTC construction vtable groups ("construction vtable for Base-in-Derived"),
+// each with all of its subobject vtables
+inline std::string construction_vtables_to_json() {
+    std::string out = "[";
+    bool first = true;
+    for (const auto &g : smart_annotator::g_groups.groups) {
+        if (g.kind != smart_annotator::GROUP_CONSTRUCTION) continue;
+        qstring symbol, demangled;
+        get_name(&symbol, g.start);
+        if (symbol.empty() || demangle_name(&demangled, symbol.c_str(), MNG_NODEFINIT) <= 0)
+            demangled = symbol;
+
+        if (!first) out += ",";
+        first = false;
+        out += "{\"address\":" + addr_str(g.start);
+        out += ",\"symbol\":" + json_str(symbol.c_str());
+        out += ",\"name\":" + json_str(demangled.c_str());
+        out += ",\"vtables\":" + subobject_array(&g, 0);
         out += "}";
     }
     out += "]";
@@ -164,12 +229,16 @@ inline std::string vtable_comparison_to_json(
 
 inline std::string vtable_hierarchy_to_json(
     const std::string &root_class,
-    const std::vector<VTableInfo> &vtables)
+    const std::vector<VTableInfo> &vtables,
+    const class_hierarchy::hierarchy_t &hierarchy)
 {
+    using class_pool::class_id_t;
+
     // Find the root vtable
+    const class_id_t root_id = class_pool::find(root_class);
     const VTableInfo *root = nullptr;
     for (const auto &vt : vtables) {
-        if (vt.class_name == root_class) {
+        if (vt.class_id == root_id) {
             root = &vt;
             break;
         }
@@ -178,57 +247,22 @@ inline std::string vtable_hierarchy_to_json(
     if (!root)
         return "{\"error\":\"class not found\",\"class_name\":" + json_str(root_class) + "}";
 
-    // Build class->vtable map
-    std::map<std::string, const VTableInfo *> vtable_map;
-    for (const auto &vt : vtables)
-        vtable_map[vt.class_name] = &vt;
-
-    // Collect ancestors
-    std::vector<std::string> ancestors;
-    {
-        std::set<std::string> seen;
-        std::function<void(const std::string &)> walk_up;
-        walk_up = [&](const std::string &cls) {
-            auto it = vtable_map.find(cls);
-            if (it == vtable_map.end()) return;
-            for (const auto &base : it->second->base_classes) {
-                if (seen.insert(base).second) {
-                    ancestors.push_back(base);
-                    walk_up(base);
-                }
-            }
-        };
-        walk_up(root_class);
-    }
+    // Depth-first over the shared hierarchy, each class once
+    std::vector<class_id_t> ancestors;
+    hierarchy.for_each_ancestor(root_id, [&](class_id_t id) { ancestors.push_back(id); });
 
-    // Collect descendants
-    std::vector<std::string> descendants;
-    {
-        std::set<std::string> seen;
-        std::function<void(const std::string &)> walk_down;
-        walk_down = [&](const std::string &cls) {
-            for (const auto &vt : vtables) {
-                for (const auto &base : vt.base_classes) {
-                    if (base == cls && seen.insert(vt.class_name).second) {
-                        descendants.push_back(vt.class_name);
-                        walk_down(vt.class_name);
-                        break;
-                    }
-                }
-            }
-        };
-        walk_down(root_class);
-    }
+    std::vector<class_id_t> descendants;
+    hierarchy.for_each_descendant(root_id, [&](class_id_t id) { descendants.push_back(id); });
 
     std::string out = "{";
-    out += "\"class_name\":" + json_str(root->class_name);
+    out += "\"class_name\":" + json_str(root->class_name());
     out += ",\"address\":" + addr_str(root->address);
     out += ",\"func_count\":" + json_int(root->func_count);
     out += ",\"is_abstract\":" + json_bool(root->pure_virtual_count > 0);
-    out += ",\"ancestors\":" + string_array(ancestors);
-    out += ",\"descendants\":" + string_array(descendants);
-    out += ",\"base_classes\":" + string_array(root->base_classes);
-    out += ",\"derived_classes\":" + string_array(root->derived_classes);
+    out += ",\"ancestors\":" + class_array(ancestors);
+    out += ",\"descendants\":" + class_array(descendants);
+    out += ",\"base_classes\":" + class_array(root->base_ids);
+    out += ",\"derived_classes\":" + class_array(root->derived_ids);
     out += "}";
     return out;
 }
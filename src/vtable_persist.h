@@ -0,0 +1,374 @@
+#pragma once
+#include <ida.hpp>
+#include <netnode.hpp>
+#include <vector>
+#include <string>
+#include "class_pool.h"
+#include "vtable_detector.h"
+#include "rtti_parser.h"
+#include "vtable_utils.h"
+
+// Stores the refreshed scan in the IDB so reopening a database skips the
+// find_vtables + RTTI + stats pipeline while its inputs are unchanged.
+
+namespace vtable_persist {
+
+constexpr const char* NETNODE_NAME = "$ vtable_explorer";
+constexpr uchar BLOB_TAG = 'V';
+constexpr uint32 BLOB_MAGIC = 0x58455456;  // "VTEX"
+constexpr uint16 FORMAT_VERSION = 5;
+constexpr size_t HASH_BLOCK_SIZE = 1 << 20;
+
+// Identifies the input a stored scan was computed from
+struct fingerprint_t {
+    uint64 segments = 0;    // layout, permissions and bytes of every segment
+    uint64 names = 0;       // name list contents
+    uint64 name_count = 0;
+
+    bool operator==(const fingerprint_t& o) const {
+        return segments == o.segments && names == o.names && name_count == o.name_count;
+    }
+    bool operator!=(const fingerprint_t& o) const { return !(*this == o); }
+};
+
+inline uint64 mix64(uint64 h, uint64 v) {
+    h ^= v + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+    return h * 0xFF51AFD7ED558CCDULL;
+}
+
+inline uint64 hash_bytes(const uint8* p, size_t n, uint64 h) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64 w;
+        memcpy(&w, p + i, 8);
+        h = (h ^ w) * 0x100000001B3ULL;
+        h ^= h >> 29;
+    }
+    for (; i < n; ++i)
+        h = (h ^ p[i]) * 0x100000001B3ULL;
+    return h;
+}
+
+// Segment bytes are hashed in fixed-size blocks on the worker pool, then the
+// block hashes are folded in address order so the result is split-independent
+inline uint64 hash_image(const memory_image::memory_image_t& img) {
+    struct block_t { const uint8* data; size_t size; };
+    std::vector<block_t> blocks;
+    uint64 h = 0xCBF29CE484222325ULL;
+
+    for (const auto& s : img.segments) {
+        h = mix64(h, s.start_ea);
+        h = mix64(h, s.end_ea);
+        h = mix64(h, s.perm);
+        if (!s.loaded) continue;
+        for (size_t off = 0; off < s.bytes.size(); off += HASH_BLOCK_SIZE)
+            blocks.push_back({s.bytes.data() + off, std::min(HASH_BLOCK_SIZE, s.bytes.size() - off)});
+    }
+
+    std::vector<uint64> block_hashes(blocks.size());
+    vtable_utils::parallel_for(blocks.size(), [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            block_hashes[i] = hash_bytes(blocks[i].data, blocks[i].size, 0xCBF29CE484222325ULL);
+    });
+
+    for (uint64 bh : block_hashes) h = mix64(h, bh);
+    return h;
+}
+
+inline fingerprint_t compute_fingerprint(const vtable_utils::name_snapshot_t& names) {
+    fingerprint_t fp;
+    fp.segments = hash_image(memory_image::g_image);
+    fp.name_count = names.size();
+    uint64 h = hash_bytes(reinterpret_cast<const uint8*>(names.text.data()), names.text.size(),
+                          0xCBF29CE484222325ULL);
+    fp.names = hash_bytes(reinterpret_cast<const uint8*>(names.eas.data()),
+                          names.eas.size() * sizeof(ea_t), h);
+    return fp;
+}
+
+// --- Compact binary encoding: LEB128 varints, zigzag for signed, string table ---
+
+struct blob_writer_t {
+    std::vector<uint8> out;
+
+    void u8(uint8 v) { out.push_back(v); }
+
+    void varint(uint64 v) {
+        while (v >= 0x80) {
+            out.push_back(uint8(v) | 0x80);
+            v >>= 7;
+        }
+        out.push_back(uint8(v));
+    }
+
+    void svarint(int64 v) { varint((uint64(v) << 1) ^ uint64(v >> 63)); }
+    void ea(ea_t v) { varint(v == BADADDR ? 0 : uint64(v) + 1); }
+    void u64(uint64 v) { for (int i = 0; i < 8; ++i) out.push_back(uint8(v >> (i * 8))); }
+
+    void bytes(const void* p, size_t n) {
+        const uint8* b = static_cast<const uint8*>(p);
+        out.insert(out.end(), b, b + n);
+    }
+};
+
+struct blob_reader_t {
+    const uint8* p;
+    const uint8* end;
+    bool ok = true;
+
+    blob_reader_t(const uint8* data, size_t size) : p(data), end(data + size) {}
+
+    uint8 u8() {
+        if (p >= end) { ok = false; return 0; }
+        return *p++;
+    }
+
+    uint64 varint() {
+        uint64 v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8 b = u8();
+            if (!ok) return 0;
+            v |= uint64(b & 0x7F) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        ok = false;
+        return 0;
+    }
+
+    int64 svarint() {
+        uint64 v = varint();
+        return int64(v >> 1) ^ -int64(v & 1);
+    }
+
+    ea_t ea() {
+        uint64 v = varint();
+        return v == 0 ? BADADDR : ea_t(v - 1);
+    }
+
+    uint64 u64() {
+        uint64 v = 0;
+        for (int i = 0; i < 8; ++i) v |= uint64(u8()) << (i * 8);
+        return v;
+    }
+
+    // Element count of a following array: every element takes at least one
+    // byte, so a count above what is left can only come from a corrupt blob
+    size_t count() {
+        const uint64 n = varint();
+        if (n > uint64(end - p)) { ok = false; return 0; }
+        return size_t(n);
+    }
+
+    std::string str(size_t n) {
+        if (size_t(end - p) < n) { ok = false; return ""; }
+        std::string s(reinterpret_cast<const char*>(p), n);
+        p += n;
+        return s;
+    }
+};
+
+inline std::vector<uint8> serialize(const std::vector<VTableInfo>& vtables,
+                                    const std::vector<ea_t>& sorted_addrs,
+                                    const fingerprint_t& fp)
+{
+    using class_pool::class_id_t;
+    class_pool::class_pool_t& pool = class_pool::g_class_pool;
+    blob_writer_t body;
+
+    // Class IDs go to the blob as-is; the pool itself is the string table.
+    // Optional IDs are stored +1 so NO_CLASS encodes as 0.
+    auto opt_id = [&](class_id_t id) { body.varint(id == class_pool::NO_CLASS ? 0 : uint64(id) + 1); };
+    auto id_list = [&](const std::vector<class_id_t>& v) {
+        body.varint(v.size());
+        for (class_id_t id : v) body.varint(id);
+    };
+
+    body.varint(vtables.size());
+    for (const auto& vt : vtables) {
+        body.ea(vt.address);
+        body.varint(vt.class_id);
+        body.varint(vt.display_id);
+        opt_id(vt.parent_id);
+        body.u8(uint8((vt.is_windows ? 1 : 0) | (vt.has_multiple_inheritance ? 2 : 0) |
+                      (vt.has_virtual_inheritance ? 4 : 0) | (vt.is_intermediate ? 8 : 0)));
+        body.varint(vt.func_count);
+        body.varint(vt.pure_virtual_count);
+        body.varint(vt.derived_count);
+        body.u8(uint8(vt.confidence));
+        body.ea(vt.parent_vtable_addr);
+        id_list(vt.base_ids);
+        id_list(vt.derived_ids);
+        body.varint(vt.secondary_vftables.size());
+        for (ea_t a : vt.secondary_vftables) body.ea(a);
+    }
+
+    // Sorted, so deltas stay small
+    body.varint(sorted_addrs.size());
+    ea_t prev = 0;
+    for (ea_t a : sorted_addrs) {
+        body.varint(uint64(a - prev));
+        prev = a;
+    }
+
+    // Records are in EA order already; their names are pool IDs too
+    const auto& rtti = rtti_parser::g_rtti_cache;
+    body.varint(rtti.records.size());
+    for (const auto& rec : rtti.records) {
+        body.ea(rec.vtable);
+        opt_id(rec.class_id);
+        body.u8(rec.flags);
+        body.varint(rec.base_count);
+        for (const auto& b : rtti.bases_of(rec)) {
+            body.varint(b.class_id);
+            body.ea(b.vtable_addr);
+            body.svarint(b.offset);
+            body.u8(b.is_virtual ? 1 : 0);
+        }
+    }
+
+    blob_writer_t blob;
+    for (int i = 0; i < 4; ++i) blob.u8(uint8(BLOB_MAGIC >> (i * 8)));
+    blob.u8(uint8(FORMAT_VERSION));
+    blob.u8(uint8(FORMAT_VERSION >> 8));
+    blob.u8(uint8(vtable_utils::get_ptr_size()));
+    blob.u64(fp.segments);
+    blob.u64(fp.names);
+    blob.u64(fp.name_count);
+    blob.varint(pool.size());
+    for (class_id_t id = 0; id < pool.size(); ++id) {
+        blob.varint(pool.length(id));
+        blob.bytes(pool.name(id), pool.length(id));
+    }
+    blob.bytes(body.out.data(), body.out.size());
+    return std::move(blob.out);
+}
+
+// Replaces the class pool with the stored one on success
+inline bool deserialize(const uint8* data, size_t size, const fingerprint_t& fp,
+                        std::vector<VTableInfo>& vtables, std::vector<ea_t>& sorted_addrs)
+{
+    using class_pool::class_id_t;
+    blob_reader_t r(data, size);
+
+    uint32 magic = 0;
+    for (int i = 0; i < 4; ++i) magic |= uint32(r.u8()) << (i * 8);
+    uint16 version = uint16(r.u8() | (r.u8() << 8));
+    uint8 ptr_size = r.u8();
+    if (!r.ok || magic != BLOB_MAGIC || version != FORMAT_VERSION ||
+        ptr_size != vtable_utils::get_ptr_size())
+        return false;
+
+    fingerprint_t stored;
+    stored.segments = r.u64();
+    stored.names = r.u64();
+    stored.name_count = r.u64();
+    if (!r.ok || stored != fp) return false;
+
+    // Stored names are distinct, so interning them in order reproduces their IDs
+    class_pool::class_pool_t pool;
+    for (size_t n = r.count(), i = 0; i < n && r.ok; ++i) {
+        std::string s = r.str(r.count());
+        if (pool.intern(s) != class_id_t(i)) r.ok = false;
+    }
+    if (!r.ok) return false;
+
+    auto id = [&]() -> class_id_t {
+        uint64 i = r.varint();
+        if (i >= pool.size()) { r.ok = false; return class_pool::NO_CLASS; }
+        return class_id_t(i);
+    };
+    auto opt_id = [&]() -> class_id_t {
+        uint64 i = r.varint();
+        if (i == 0) return class_pool::NO_CLASS;
+        if (i > pool.size()) { r.ok = false; return class_pool::NO_CLASS; }
+        return class_id_t(i - 1);
+    };
+    auto id_list = [&](std::vector<class_id_t>& v) {
+        v.resize(r.count());
+        for (auto& x : v) x = id();
+    };
+
+    std::vector<VTableInfo> loaded(r.count());
+    for (auto& vt : loaded) {
+        vt.address = r.ea();
+        vt.class_id = id();
+        vt.display_id = id();
+        vt.parent_id = opt_id();
+        uint8 flags = r.u8();
+        vt.is_windows = (flags & 1) != 0;
+        vt.has_multiple_inheritance = (flags & 2) != 0;
+        vt.has_virtual_inheritance = (flags & 4) != 0;
+        vt.is_intermediate = (flags & 8) != 0;
+        vt.func_count = (int)r.varint();
+        vt.pure_virtual_count = (int)r.varint();
+        vt.derived_count = (int)r.varint();
+        vt.confidence = r.u8();
+        vt.parent_vtable_addr = r.ea();
+        id_list(vt.base_ids);
+        id_list(vt.derived_ids);
+        vt.secondary_vftables.resize(r.count());
+        for (auto& a : vt.secondary_vftables) a = r.ea();
+        if (!r.ok) return false;
+    }
+
+    std::vector<ea_t> addrs(r.count());
+    ea_t prev = 0;
+    for (size_t i = 0; i < addrs.size() && r.ok; ++i) {
+        const uint64 delta = r.varint();
+        if (i > 0 && delta == 0) r.ok = false;  // strictly increasing
+        addrs[i] = prev + ea_t(delta);
+        prev = addrs[i];
+    }
+    if (!r.ok) return false;
+
+    // sorted_addrs holds exactly the distinct vtable addresses
+    std::vector<ea_t> expected;
+    expected.reserve(loaded.size());
+    for (const auto& vt : loaded) expected.push_back(vt.address);
+    std::sort(expected.begin(), expected.end());
+    expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+    if (expected != addrs) return false;
+
+    rtti_parser::rtti_cache_t rtti;
+    std::vector<rtti_parser::base_record_t> bases;
+    for (uint64 n = r.varint(); n > 0 && r.ok; --n) {
+        const ea_t ea = r.ea();
+        const class_id_t cls = opt_id();
+        const uint8 flags = r.u8();
+        bases.resize(r.count());
+        for (auto& b : bases) {
+            b.class_id = id();
+            b.vtable_addr = r.ea();
+            b.offset = int32(r.svarint());
+            b.is_virtual = r.u8() != 0;
+        }
+        if (r.ok && !rtti.append(ea, cls, flags, bases)) r.ok = false;
+    }
+    if (!r.ok) return false;
+
+    vtables = std::move(loaded);
+    sorted_addrs = std::move(addrs);
+    rtti_parser::g_rtti_cache = std::move(rtti);
+    class_pool::g_class_pool = std::move(pool);
+    return true;
+}
+
+inline void save(const std::vector<VTableInfo>& vtables, const std::vector<ea_t>& sorted_addrs,
+                 const fingerprint_t& fp)
+{
+    std::vector<uint8> blob = serialize(vtables, sorted_addrs, fp);
+    netnode node(NETNODE_NAME, 0, true);
+    node.delblob(0, BLOB_TAG);
+    node.setblob(blob.data(), blob.size(), 0, BLOB_TAG);
+}
+
+inline bool load(const fingerprint_t& fp, std::vector<VTableInfo>& vtables, std::vector<ea_t>& sorted_addrs) {
+    netnode node(NETNODE_NAME);
+    if (node == BADNODE) return false;
+
+    bytevec_t blob;
+    if (node.getblob(&blob, 0, BLOB_TAG) <= 0 || blob.empty()) return false;
+    return deserialize(&blob[0], blob.size(), fp, vtables, sorted_addrs);
+}
+
+} // namespace vtable_persist
@@ -1,5 +1,14 @@
 #pragma once
 #include <ida.hpp>
+#include <name.hpp>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <cctype>
+#include "memory_image.h"
 
 namespace vtable_utils {
 
@@ -14,6 +23,20 @@ constexpr int MAX_VTABLE_ENTRIES = 2048;
 constexpr int CONSECUTIVE_INVALID_THRESHOLD = 5;
 constexpr int DEFAULT_VFUNC_START_OFFSET = 2;
 constexpr int MAX_VFUNC_SEARCH_DEPTH = 4;
+constexpr size_t CONFIG_VOTE_SAMPLE = 64;  // vtables probed per segment when detecting RTTI layout
+constexpr int MAX_GROUP_WORDS = 4 * MAX_VTABLE_ENTRIES;  // one Itanium vtable group, all subobject vtables
+constexpr int MAX_VCALL_OFFSETS = 32;                    // vcall/vbase offset words ahead of a secondary header
+constexpr int64 MAX_SUBOBJECT_OFFSET = int64(1) << 24;
+
+// Symbol-less discovery (confidence is 0-100)
+constexpr int SYMBOL_CONFIDENCE = 100;
+constexpr int DISCOVERY_RTTI_CONFIDENCE = 95;
+constexpr int DISCOVERY_BARE_BASE_CONFIDENCE = 30;
+constexpr int DISCOVERY_BARE_SLOT_CONFIDENCE = 5;
+constexpr uint32 DISCOVERY_BARE_SLOT_CAP = 10;
+constexpr uint32 DISCOVERY_MIN_BARE_SLOTS = 4;
+constexpr int DISCOVERY_MIN_CONFIDENCE = 50;
+constexpr size_t DISCOVERY_BLOCK_WORDS = 4096;
 
 // Buffers
 constexpr size_t COMMENT_BUFFER_SIZE = 128;
@@ -22,6 +45,8 @@ constexpr size_t INDEX_CACHE_SIZE = 16;
 constexpr size_t ADDRESS_CACHE_SIZE = 32;
 constexpr size_t VTABLE_RESERVE_RATIO = 100;
 constexpr size_t ENTRY_RESERVE_SIZE = 64;
+constexpr size_t NAME_STACK_BUFFER_SIZE = 512;
+constexpr size_t STRING_WINDOW_SIZE = 4096;  // RTTI name reads never cross this alignment in one fetch
 
 // Opcodes
 constexpr uint8 OPCODE_PUSH_RBP = 0x55;
@@ -29,6 +54,10 @@ constexpr uint8 OPCODE_REX_W = 0x48;
 constexpr uint8 OPCODE_REX = 0x40;
 constexpr uint8 OPCODE_REX_B = 0x41;
 
+// Threading
+constexpr size_t PARALLEL_MIN_ITEMS = 4096;
+constexpr unsigned MAX_WORKER_THREADS = 16;
+
 // Colors (BGR)
 constexpr uint32 GRAPH_NORMAL = 0x706050;
 constexpr uint32 GRAPH_SELECTED = 0xA08070;
@@ -45,6 +74,71 @@ constexpr uint32 CLASS_MULTIPLE_INHERIT = 0xD0A080;
 constexpr uint32 CLASS_VIRTUAL_INHERIT = 0x8080D0;
 constexpr uint32 DEFAULT_BG = 0xFFFFFF;
 
+// Set to false to force every parallel pass to run serially on the calling thread
+static bool g_parallel_scan = true;
+
+// Set to false to only report vtables that have a symbol or a ??_R4 locator
+static bool g_discover_unnamed = true;
+
+// Number of chunks parallel_for() splits `count` items into
+inline size_t parallel_chunks(size_t count) {
+    if (!g_parallel_scan || count < 2 * PARALLEL_MIN_ITEMS) return 1;
+    unsigned hw = std::thread::hardware_concurrency();
+    size_t workers = hw ? std::min(hw, MAX_WORKER_THREADS) : 1;
+    return std::max<size_t>(1, std::min(workers, count / PARALLEL_MIN_ITEMS));
+}
+
+// Runs fn(chunk, begin, end) over contiguous chunks of [0, count), chunk 0 on the
+// calling thread. Workers must not call into the IDA kernel.
+template<typename Fn>
+inline void parallel_for(size_t count, Fn&& fn) {
+    const size_t chunks = parallel_chunks(count);
+    const size_t per_chunk = (count + chunks - 1) / std::max<size_t>(chunks, 1);
+    if (chunks <= 1) {
+        fn(size_t(0), size_t(0), count);
+        return;
+    }
+
+    std::vector<std::thread> pool;
+    pool.reserve(chunks - 1);
+    for (size_t c = 1; c < chunks; ++c) {
+        size_t begin = std::min(count, c * per_chunk);
+        size_t end = std::min(count, begin + per_chunk);
+        pool.emplace_back([&fn, c, begin, end] { fn(c, begin, end); });
+    }
+    fn(size_t(0), size_t(0), std::min(count, per_chunk));
+    for (auto& t : pool) t.join();
+}
+
+// Contiguous read-only copy of the IDA name list, shareable with worker threads
+struct name_snapshot_t {
+    std::vector<char> text;
+    std::vector<size_t> offsets;
+    std::vector<ea_t> eas;
+
+    void capture() {
+        const size_t count = get_nlist_size();
+        text.clear();
+        offsets.clear();
+        eas.clear();
+        offsets.reserve(count);
+        eas.reserve(count);
+        text.reserve(count * 32);
+
+        for (size_t i = 0; i < count; ++i) {
+            const char* name = get_nlist_name(i);
+            offsets.push_back(text.size());
+            eas.push_back(get_nlist_ea(i));
+            if (name) text.insert(text.end(), name, name + strlen(name));
+            text.push_back('\0');
+        }
+    }
+
+    size_t size() const { return eas.size(); }
+    const char* name(size_t i) const { return text.data() + offsets[i]; }
+    ea_t ea(size_t i) const { return eas[i]; }
+};
+
 // Formatters
 inline void format_address(char* buf, size_t sz, ea_t addr) {
     qsnprintf(buf, sz, "0x%llX", (unsigned long long)addr);
@@ -70,69 +164,221 @@ inline int get_ptr_size() {
     return ps;
 }
 
-inline ea_t read_ptr(ea_t addr) {
-    if (!is_mapped(addr)) return BADADDR;
-    return get_ptr_size() == 8 ? get_qword(addr) : get_dword(addr);
+// Backend-neutral reads: served from memory_image::g_image while a snapshot is
+// loaded (thread-safe, no kernel calls), otherwise from the database
+inline bool is_addr_mapped(ea_t addr) {
+    const auto& img = memory_image::g_image;
+    return img.valid ? img.is_mapped(addr) : is_mapped(addr);
 }
 
-inline int32 read_int32(ea_t addr) {
-    return is_mapped(addr) ? get_dword(addr) : 0;
+inline bool is_exec_addr(ea_t addr) {
+    const auto& img = memory_image::g_image;
+    if (img.valid) return img.is_exec(addr);
+    segment_t* seg = getseg(addr);
+    return seg && (seg->perm & SEGPERM_EXEC);
+}
+
+// End of the segment holding addr, BADADDR if unmapped
+inline ea_t segment_end(ea_t addr) {
+    const auto& img = memory_image::g_image;
+    if (img.valid) {
+        const auto* s = img.find(addr);
+        return s ? s->end_ea : BADADDR;
+    }
+    segment_t* seg = getseg(addr);
+    return seg ? seg->end_ea : BADADDR;
 }
 
-inline std::string normalize_msvc_nested_class(const std::string& name) {
-    if (name.find('@') == std::string::npos) return name;
+inline uint8 read_byte(ea_t addr) {
+    const auto& img = memory_image::g_image;
+    return img.valid ? img.get_byte(addr) : get_byte(addr);
+}
 
-    std::vector<std::string> components;
-    size_t start = 0;
-    size_t pos;
+inline uint32 read_dword(ea_t addr) {
+    const auto& img = memory_image::g_image;
+    return img.valid ? img.get_dword(addr) : get_dword(addr);
+}
 
-    while ((pos = name.find('@', start)) != std::string::npos) {
-        components.push_back(name.substr(start, pos - start));
-        start = pos + 1;
-    }
-    components.push_back(name.substr(start));
+inline uint64 read_qword(ea_t addr) {
+    const auto& img = memory_image::g_image;
+    return img.valid ? img.get_qword(addr) : get_qword(addr);
+}
+
+inline size_t read_bytes(ea_t addr, void* out, size_t size) {
+    const auto& img = memory_image::g_image;
+    if (img.valid) return img.read(addr, out, size);
+    ssize_t n = get_bytes(out, (ssize_t)size, addr, GMB_READALL);
+    return n > 0 ? size_t(n) : 0;
+}
 
-    std::string result;
-    for (auto it = components.rbegin(); it != components.rend(); ++it) {
-        if (it->empty()) continue;
-        if (!result.empty()) result += "::";
-        result += *it;
+// Executable segment table, sorted by address: the image's own table while a
+// snapshot is loaded, otherwise built into `out`
+inline const std::vector<memory_image::addr_range_t>& get_exec_ranges(std::vector<memory_image::addr_range_t>& out) {
+    const auto& img = memory_image::g_image;
+    if (img.valid) return img.exec_ranges;
+    out.clear();
+    for (int i = 0, n = get_segm_qty(); i < n; ++i) {
+        segment_t* seg = getnseg(i);
+        if (!seg || !(seg->perm & SEGPERM_EXEC)) continue;
+        if (!out.empty() && out.back().end_ea == seg->start_ea)
+            out.back().end_ea = seg->end_ea;
+        else
+            out.push_back({seg->start_ea, seg->end_ea});
     }
-    return result;
+    return out;
 }
 
-inline std::string clean_msvc_decorated_name(const std::string& name) {
-    std::string result = name;
+// Bulk read of [addr, addr + size) that stops at the first unmapped byte.
+// Returns a pointer into the image when possible, otherwise fills `scratch`.
+inline const uint8* read_mapped_span(ea_t addr, size_t size, std::vector<uint8>& scratch, size_t* got) {
+    const auto& img = memory_image::g_image;
+    if (img.valid) {
+        size_t avail = 0;
+        const uint8* p = img.view(addr, &avail);
+        if (p && avail >= size) {
+            *got = size;
+            return p;
+        }
+        scratch.resize(size);
+        *got = img.read(addr, scratch.data(), size);
+        return scratch.data();
+    }
 
-    size_t template_marker = result.rfind("?$");
-    if (template_marker != std::string::npos) {
-        result = result.substr(template_marker + 2);
+    ea_t end = addr;
+    while (end < addr + size) {
+        segment_t* seg = getseg(end);
+        if (!seg) break;
+        end = seg->end_ea;
     }
+    size_t avail = (size_t)std::min<ea_t>(end - addr, size);
+    scratch.resize(avail);
+    ssize_t n = avail ? get_bytes(scratch.data(), (ssize_t)avail, addr, GMB_READALL) : 0;
+    *got = n > 0 ? size_t(n) : 0;
+    return scratch.data();
+}
+
+inline ea_t image_base() {
+    const auto& img = memory_image::g_image;
+    return img.valid ? img.imagebase : get_imagebase();
+}
+
+inline ea_t read_ptr(ea_t addr) {
+    if (!is_addr_mapped(addr)) return BADADDR;
+    return get_ptr_size() == 8 ? read_qword(addr) : read_dword(addr);
+}
+
+inline int32 read_int32(ea_t addr) {
+    return is_addr_mapped(addr) ? (int32)read_dword(addr) : 0;
+}
 
-    size_t scope_hash = result.find("::$");
-    while (scope_hash != std::string::npos) {
-        size_t scope_end = result.find("::", scope_hash + 2);
-        if (scope_end != std::string::npos) {
-            result.erase(scope_hash, scope_end - scope_hash + 2);
-        } else {
-            break;
+// Output size normalize_msvc_nested_class() needs for a `len`-char name ('@' -> "::")
+constexpr size_t normalized_capacity(size_t len) { return 2 * len + 1; }
+
+// "Inner@Outer@ns" -> "ns::Outer::Inner" in one right-to-left pass, empty
+// components dropped. Names without '@' are copied unchanged. `out` must
+// hold normalized_capacity(name.size()) chars and must not overlap `name`.
+inline size_t normalize_msvc_nested_class(std::string_view name, char* out) {
+    size_t len = 0;
+    size_t end = name.size();
+    for (size_t i = name.size(); i-- > 0;) {
+        if (name[i] != '@') continue;
+        if (end > i + 1) {
+            if (len) { out[len++] = ':'; out[len++] = ':'; }
+            memcpy(out + len, name.data() + i + 1, end - i - 1);
+            len += end - i - 1;
         }
-        scope_hash = result.find("::$");
+        end = i;
+    }
+    if (end > 0) {
+        if (len) { out[len++] = ':'; out[len++] = ':'; }
+        memcpy(out + len, name.data(), end);
+        len += end;
     }
+    out[len] = '\0';
+    return len;
+}
 
-    if (!result.empty()) {
-        if (result[0] == '$' && result.length() > 3) {
-            size_t prefix_end = result.find_first_not_of("0123456789ABCDEFabcdef", 1);
-            if (prefix_end != std::string::npos && prefix_end > 1) {
-                result = result.substr(prefix_end);
-            }
+inline bool is_hex_digit(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+}
+
+// Strips MSVC decoration left in a demangled name: everything up to the last
+// "?$", "::$hash::" scopes, a leading "$<hex>" prefix and a stray V/U type
+// code. Single forward pass with read/write cursors; `out` must hold
+// name.size() + 1 chars and may be name.data() itself.
+inline size_t clean_msvc_decorated_name(std::string_view name, char* out) {
+    size_t r = 0;
+    for (size_t i = name.size(); i >= 2; --i) {
+        if (name[i - 2] == '?' && name[i - 1] == '$') { r = i; break; }
+    }
+    const char* in = name.data();
+    const size_t n = name.size();
+
+    // Drop "::$...::" scopes. A match can straddle what is already written,
+    // so the last two output chars are part of the test.
+    size_t w = 0;
+    while (r < n) {
+        size_t match = SIZE_MAX;
+        size_t search = 0;  // where the closing "::" search starts in `in`
+        if (w >= 2 && out[w - 2] == ':' && out[w - 1] == ':' && in[r] == '$') {
+            match = w - 2; search = r;
+        } else if (w >= 1 && out[w - 1] == ':' && in[r] == ':' && r + 1 < n && in[r + 1] == '$') {
+            match = w - 1; search = r + 1;
+        } else if (r + 2 < n && in[r] == ':' && in[r + 1] == ':' && in[r + 2] == '$') {
+            match = w; search = r + 2;
         }
-        if (result.length() > 1 && (result[0] == 'V' || result[0] == 'U') && isupper(result[1])) {
-            result = result.substr(1);
+        if (match == SIZE_MAX) {
+            out[w++] = in[r++];
+            continue;
         }
+
+        size_t close = search;
+        while (close + 1 < n && !(in[close] == ':' && in[close + 1] == ':')) ++close;
+        if (close + 1 >= n) break;  // unterminated: keep the rest as is
+        w = match;
+        r = close + 2;
+    }
+    if (r < n) {
+        memmove(out + w, in + r, n - r);
+        w += n - r;
     }
 
-    return result;
+    size_t skip = 0;
+    if (w > 3 && out[0] == '$') {
+        size_t p = 1;
+        while (p < w && is_hex_digit(out[p])) ++p;
+        if (p < w && p > 1) skip = p;
+    }
+    if (w - skip > 1 && (out[skip] == 'V' || out[skip] == 'U') && isupper((unsigned char)out[skip + 1]))
+        ++skip;
+    if (skip) memmove(out, out + skip, w - skip);
+    w -= skip;
+    out[w] = '\0';
+    return w;
+}
+
+// std::string forms; the work happens in a stack buffer unless the name is huge
+inline std::string normalize_msvc_nested_class(std::string_view name) {
+    if (name.find('@') == std::string_view::npos) return std::string(name);
+    char stack[NAME_STACK_BUFFER_SIZE];
+    std::vector<char> heap;
+    char* out = stack;
+    if (normalized_capacity(name.size()) > sizeof(stack)) {
+        heap.resize(normalized_capacity(name.size()));
+        out = heap.data();
+    }
+    return std::string(out, normalize_msvc_nested_class(name, out));
+}
+
+inline std::string clean_msvc_decorated_name(std::string_view name) {
+    char stack[NAME_STACK_BUFFER_SIZE];
+    std::vector<char> heap;
+    char* out = stack;
+    if (name.size() + 1 > sizeof(stack)) {
+        heap.resize(name.size() + 1);
+        out = heap.data();
+    }
+    return std::string(out, clean_msvc_decorated_name(name, out));
 }
 
 } // namespace vtable_utils